@@ -1,7 +1,11 @@
 /* DataParser.c */
 #include "DataParser.h"
 #include "DocPage.h"
+#include "IntermediateRun.h"
+#include "Tokenizer.h"
 #include <ctype.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
@@ -9,92 +13,117 @@
 #include <unistd.h>
 
 /**
- * Maps a portion of file content to memory and processes special characters
+ * Maps a portion of file content to memory, read-only
+ * The mapping is tokenized in place, nothing is copied or modified
  * @param file File pointer to read from
  * @param mapSize Number of bytes to map
  * @param offset Starting position in file (has to be a multiple of page size)
- * @param remainingContent Previous unprocessed content (used for concatenation, if any)
- * @return Processed content buffer
+ * @return Mapped content, to be released with munmap
  */
-char *mapRawContentFromDisk(FILE *file, size_t mapSize, size_t offset, char *remainingContent) {
+const char *mapRawContentFromDisk(FILE *file, size_t mapSize, size_t offset) {
     // Memory map the file segment
     char *mapContent = mmap(NULL, mapSize, PROT_READ, MAP_PRIVATE, fileno(file), (off_t)offset);
     if (mapContent == MAP_FAILED) {
         printf("Error mapping file!\n");
         exit(1);
     }
-    // Process special characters, keeping only alphanumeric, tab, and newline
-    char *tempBuffer = (char *)malloc(mapSize + 1);
-    for (size_t i = 0; i < mapSize; i++) {
-        if (mapContent[i] == '\t' || mapContent[i] == '\n' || isalnum(mapContent[i])) {
-            tempBuffer[i] = mapContent[i];
-        } else {
-            tempBuffer[i] = ' ';
-        }
-    }
-    tempBuffer[mapSize] = '\0';
-    // Combine with remaining content if exists
-    char *buffer = NULL;
-    if (remainingContent != NULL) {
-        buffer = (char *)malloc(strlen(remainingContent) + mapSize + 1);
-        strcpy(buffer, remainingContent);
-        strcat(buffer, tempBuffer);
-        free(remainingContent);
-    } else {
-        buffer = (char *)malloc(mapSize + 1);
-        strcpy(buffer, tempBuffer);
-    }
-    free(tempBuffer);
-    // Clean up mapped content
-    if (munmap(mapContent, mapSize) == -1) {
-        printf("Error unmapping file!\n");
+    // Content is read once from front to back
+    madvise(mapContent, mapSize, MADV_SEQUENTIAL);
+    return mapContent;
+}
+
+/**
+ * Starts reading mapped content from disk in the background
+ * The kernel reads the pages ahead while the previous segment is still being parsed
+ * @param content Mapped content returned by mapRawContentFromDisk
+ * @param mapSize Number of mapped bytes
+ */
+void prefetchRawContent(const char *content, size_t mapSize) {
+    madvise((void *)content, mapSize, MADV_WILLNEED);
+}
+
+/**
+ * Appends bytes to a heap buffer holding a line split by a segment boundary
+ * @param line Pointer to the buffer, reallocated as needed
+ * @param lineLength Pointer to the length of the buffer
+ * @param content Bytes to append
+ * @param length Number of bytes to append
+ */
+void appendToCarriedLine(char **line, size_t *lineLength, const char *content, size_t length) {
+    *line = (char *)realloc(*line, *lineLength + length);
+    if (*line == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
     }
-    return buffer;
+    memcpy(*line + *lineLength, content, length);
+    *lineLength += length;
 }
 
 /**
- * Writes hash table contents to a binary file in alphabetically sorted order of words
+ * Writes hash table contents to a compressed intermediate file in alphabetically sorted order of words
+ * Words are replaced by their term ids, docIds are gap encoded and all integers are VByte encoded, see IntermediateRun.h
  * @param table Hash table to write
+ * @param vocabulary Global vocabulary assigning the term ids
  * @param outputFileName Name of output file
  */
-void writeHashTableToDisk(const HashTable *table, const char *outputFileName) {
+void writeHashTableToDisk(const HashTable *table, Vocabulary *vocabulary, const char *outputFileName) {
     FILE *file = fopen(outputFileName, "wb");
     if (file == NULL) {
         printf("Error opening file %s!\n", outputFileName);
         exit(1);
     }
-    // Get sorted list of words from hash table
-    char **words = getSortedWordsFromHashTable(table);
-    // Write each word's data in binary format
+    // Encoding buffer large enough for a full posting block
+    uint8_t *byteBuffer = (uint8_t *)malloc(MAX_POSTING_BLOCK_CAPACITY * MAX_VARBYTE_LENGTH);
+    if (byteBuffer == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    // Get entries sorted by word from hash table
+    HashTableEntry **entries = getSortedEntriesFromHashTable(table);
+    // Write each word's data in compressed binary format
     for (int wordIndex = 0; wordIndex < table->wordCount; wordIndex++) {
-        HashTableEntry *currentEntry = table->slots[hashFunction(words[wordIndex])];
-        while (currentEntry != NULL) {
-            if (strcmp(currentEntry->word, words[wordIndex]) == 0) {
-                LinkedList *list = currentEntry->list;
-                // Write word length and word
-                fwrite(&currentEntry->wordLength, sizeof(int), 1, file);
-                fwrite(currentEntry->word, sizeof(char), strlen(currentEntry->word), file);
-                // Write number of postings
-                fwrite(&list->nodeCount, sizeof(int), 1, file);
-                // Write docId for each posting, not interleaved
-                LinkedListNode *currentNode = list->headNode;
-                while (currentNode != NULL) {
-                    fwrite(&currentNode->docId, sizeof(int), 1, file);
-                    currentNode = currentNode->next;
-                }
-                // Write frequency for each posting, not interleaved
-                currentNode = list->headNode;
-                while (currentNode != NULL) {
-                    fwrite(&currentNode->frequency, sizeof(int), 1, file);
-                    currentNode = currentNode->next;
-                }
-                break;
+        const HashTableEntry *currentEntry = entries[wordIndex];
+        const PostingList *list = &currentEntry->list;
+        // Measure the encoded docId gaps and frequencies, their byte lengths precede them
+        size_t docIdByteLength = 0;
+        size_t frequencyByteLength = 0;
+        int prevDocId = 0;
+        for (const PostingBlock *block = list->headBlock; block != NULL; block = block->next) {
+            for (int postingIndex = 0; postingIndex < block->postingCount; postingIndex++) {
+                docIdByteLength += computeVarByteSize((uint32_t)(block->docIds[postingIndex] - prevDocId));
+                frequencyByteLength += computeVarByteSize((uint32_t)block->frequencies[postingIndex]);
+                prevDocId = block->docIds[postingIndex];
             }
-            currentEntry = currentEntry->next;
+        }
+        // Write term id, number of postings and byte lengths
+        int termId = getTermId(vocabulary, currentEntry->word, currentEntry->wordLength);
+        size_t byteCount = encodeVarByte((uint32_t)termId, byteBuffer);
+        byteCount += encodeVarByte((uint32_t)list->postingCount, byteBuffer + byteCount);
+        byteCount += encodeVarByte((uint32_t)docIdByteLength, byteBuffer + byteCount);
+        byteCount += encodeVarByte((uint32_t)frequencyByteLength, byteBuffer + byteCount);
+        fwrite(byteBuffer, 1, byteCount, file);
+        // Write docId gaps block by block, not interleaved
+        prevDocId = 0;
+        for (const PostingBlock *block = list->headBlock; block != NULL; block = block->next) {
+            byteCount = 0;
+            for (int postingIndex = 0; postingIndex < block->postingCount; postingIndex++) {
+                byteCount += encodeVarByte((uint32_t)(block->docIds[postingIndex] - prevDocId), byteBuffer + byteCount);
+                prevDocId = block->docIds[postingIndex];
+            }
+            fwrite(byteBuffer, 1, byteCount, file);
+        }
+        // Write frequencies block by block, not interleaved
+        for (const PostingBlock *block = list->headBlock; block != NULL; block = block->next) {
+            byteCount = 0;
+            for (int postingIndex = 0; postingIndex < block->postingCount; postingIndex++) {
+                byteCount += encodeVarByte((uint32_t)block->frequencies[postingIndex], byteBuffer + byteCount);
+            }
+            fwrite(byteBuffer, 1, byteCount, file);
         }
     }
     printf("File %s written with %d words in hash table.\n", outputFileName, table->wordCount);
-    free(words);
+    free(entries);
+    free(byteBuffer);
     fclose(file);
 }
 
@@ -116,9 +145,75 @@ void writeDocLengthsToDisk(const int *docLengths) {
     fclose(file);
 }
 
+/**
+ * Parses a range of complete lines, i.e., <docId>\t<document content>\n, into a hash table
+ * Tokens are maximal runs of alphanumeric characters found by the shared block tokenizer, passed to the hash table as (pointer, length) pairs,
+ * so the content is only read and may be a read-only mapping
+ * @param contentStart First byte of the range, at the start of a line
+ * @param contentEnd End of the range (exclusive), right after a newline or at the end of the file
+ * @param table Hash table to update
+ * @param docLengths Array of document lengths to fill
+ */
+void parseLines(const char *contentStart, const char *contentEnd, HashTable *table, int *docLengths) {
+    const char *lineStart = contentStart;
+    // Process each line in the range
+    while (lineStart < contentEnd) {
+        const char *lineEnd = memchr(lineStart, '\n', contentEnd - lineStart);
+        if (lineEnd == NULL) {
+            // Last line of the file without trailing newline
+            lineEnd = contentEnd;
+        }
+        // Split line by tab character, separating docId and document content
+        const char *tabPos = memchr(lineStart, '\t', lineEnd - lineStart);
+        if (tabPos != NULL) {
+            // Read docId from the first field, which may end at the end of the mapping
+            int docId = 0;
+            const char *digit = lineStart;
+            while (digit < tabPos && !isalnum((unsigned char)*digit)) {
+                digit++;
+            }
+            while (digit < tabPos && isdigit((unsigned char)*digit)) {
+                docId = docId * 10 + (*digit - '0');
+                digit++;
+            }
+            int wordCount = 0;
+            // Split words at non-alphanumeric characters and process each word
+            TokenScanner scanner;
+            initTokenScanner(&scanner, tabPos + 1, lineEnd);
+            int wordLength;
+            const char *wordStart;
+            while ((wordStart = nextToken(&scanner, &wordLength)) != NULL) {
+                // Update hash table with word and docId
+                updateHashTable(table, wordStart, wordLength, docId);
+                wordCount++;
+            }
+            docLengths[docId] = wordCount;
+        }
+        lineStart = lineEnd + 1;
+    }
+}
+
+/**
+ * Worker thread parsing a range of lines into its own hash table and writing it as an intermediate file
+ * Workers share nothing but the document lengths array, where each one only writes the documents of its own lines
+ * The hash table is reset afterwards, so its memory is reused for the worker's range of the next segment
+ * @param arg Parser task
+ * @return NULL
+ */
+void *parserWorker(void *arg) {
+    ParserTask *task = (ParserTask *)arg;
+    parseLines(task->contentStart, task->contentEnd, task->table, task->docLengths);
+    // Sorting and writing happen on the run writer thread while the next segment is parsed
+    submitRun(task->writer, task->table, task->outputFileName);
+    return NULL;
+}
+
 /**
  * Main function for parsing data
  * Parses input data file and creates intermediate binary files
+ * Each segment is tokenized directly in its read-only mapping, only a line split by a segment boundary is copied.
+ * Segments are split at line boundaries into PARSER_THREAD_COUNT ranges of equal size, parsed by worker threads in parallel,
+ * intermediate files are numbered in document order so that merging them keeps postings sorted by docId
  */
 void parseData() {
     struct timeval start, end;
@@ -134,70 +229,98 @@ void parseData() {
     fseek(file, 0, SEEK_SET);
     // Initialize processing variables
     size_t offset = 0;
-    char *remainingContent = NULL;
+    char *carriedLine = NULL;   // Line split by the previous segment boundary
+    size_t carriedLength = 0;
     int fileNumber = 0;
     int *docLengths = (int *)malloc(sizeof(int) * DOC_COUNT);
+    ParserTask tasks[PARSER_THREAD_COUNT];
+    pthread_t threads[PARSER_THREAD_COUNT];
+    Vocabulary *vocabulary = createVocabulary();
+    RunWriter *writer = createRunWriter(PARSER_TABLE_COUNT, vocabulary);
+    // Map the first segment, later segments are mapped one ahead of parsing
+    size_t mapSize = (fileSize < READ_SIZE) ? fileSize : READ_SIZE;
+    const char *segment = (fileSize > 0) ? mapRawContentFromDisk(file, mapSize, offset) : NULL;
     // Process file in segments of READ_SIZE bytes
     while (offset < fileSize) {
-        // Determine size of next segment to read
-        size_t remainingFileSize = fileSize - offset;
-        size_t mapSize = (remainingFileSize < READ_SIZE) ? remainingFileSize : READ_SIZE;
-        // Map the segment of file content to memory and process
-        char *buffer = mapRawContentFromDisk(file, mapSize, offset, remainingContent);
-        char *lineStart = buffer;
-        HashTable *table = createHashTable();
-        // Process each line in the segment
-        while (*lineStart != '\0') {
-            char *lineEnd = strchr(lineStart, '\n');
-            if (lineEnd != NULL) {
-                *lineEnd = '\0';
-            } else {
-                // If lineEnd is NULL, then save the incomplete line for next segment
-                remainingContent = (char *)malloc(strlen(lineStart) + 1);
-                strcpy(remainingContent, lineStart);
-                break;
+        bool isLastSegment = (offset + mapSize == fileSize);
+        const char *segmentEnd = segment + mapSize;
+        const char *contentStart = segment;
+        // Take one empty hash table per worker, waiting only if the tables of two segments ago are still being written
+        for (int threadIndex = 0; threadIndex < PARSER_THREAD_COUNT; threadIndex++) {
+            tasks[threadIndex].table = acquireHashTable(writer);
+            tasks[threadIndex].writer = writer;
+        }
+        // Complete the line split by the previous segment boundary
+        if (carriedLength > 0) {
+            const char *firstLineEnd = memchr(segment, '\n', mapSize);
+            contentStart = (firstLineEnd != NULL) ? firstLineEnd + 1 : segmentEnd;
+            appendToCarriedLine(&carriedLine, &carriedLength, segment, contentStart - segment);
+            if (firstLineEnd != NULL || isLastSegment) {
+                // It precedes all lines of this segment, so it goes to the first worker's hash table
+                parseLines(carriedLine, carriedLine + carriedLength, tasks[0].table, docLengths);
+                carriedLength = 0;
             }
-            // Split line by tab character, separating docId and document content
-            char *tabPos = strchr(lineStart, '\t');
-            if (tabPos != NULL) {
-                *tabPos = '\0';
-                int docId = (int)strtol(lineStart, NULL, 10);
-                int wordCount = 0;
-                // Split words by space character and process each word
-                char *wordsStart = tabPos + 1;
-                char *wordStart = wordsStart;
-                while (*wordStart != '\0') {
-                    char *spacePos = strchr(wordStart, ' ');
-                    if (spacePos != NULL) {
-                        *spacePos = '\0';
-                        if (spacePos == wordStart) {
-                            wordStart = spacePos + 1;
-                            continue;
-                        }
-                    }
-                    // Update hash table with word and docId
-                    updateHashTable(table, wordStart, docId);
-                    wordCount++;
-                    if (spacePos != NULL) {
-                        wordStart = spacePos + 1;
-                    } else {
-                        wordStart = lineEnd;
-                    }
+        }
+        // Save the incomplete last line for next segment
+        const char *contentEnd = segmentEnd;
+        if (!isLastSegment) {
+            while (contentEnd > contentStart && contentEnd[-1] != '\n') {
+                contentEnd--;
+            }
+            appendToCarriedLine(&carriedLine, &carriedLength, contentEnd, segmentEnd - contentEnd);
+        }
+        // Split complete lines into ranges of roughly equal size, one per worker
+        const char *rangeStart = contentStart;
+        for (int threadIndex = 0; threadIndex < PARSER_THREAD_COUNT; threadIndex++) {
+            const char *rangeEnd = contentEnd;
+            if (threadIndex < PARSER_THREAD_COUNT - 1) {
+                const char *target = contentStart + (contentEnd - contentStart) * (threadIndex + 1) / PARSER_THREAD_COUNT;
+                if (target < rangeStart) {
+                    target = rangeStart;
                 }
-                docLengths[docId] = wordCount;
+                const char *newline = (target < contentEnd) ? memchr(target, '\n', contentEnd - target) : NULL;
+                rangeEnd = (newline != NULL) ? newline + 1 : contentEnd;
             }
-            lineStart = lineEnd + 1;
+            tasks[threadIndex].contentStart = rangeStart;
+            tasks[threadIndex].contentEnd = rangeEnd;
+            tasks[threadIndex].docLengths = docLengths;
+            sprintf(tasks[threadIndex].outputFileName, "Intermediate%d.bin", fileNumber);
+            fileNumber++;
+            rangeStart = rangeEnd;
+        }
+        // Parse ranges in parallel, each worker queues its hash table for the run writer
+        for (int threadIndex = 0; threadIndex < PARSER_THREAD_COUNT; threadIndex++) {
+            if (pthread_create(&threads[threadIndex], NULL, parserWorker, &tasks[threadIndex]) != 0) {
+                printf("Error creating thread!\n");
+                exit(1);
+            }
+        }
+        // Map the next segment and let the kernel read it ahead while this one is parsed
+        size_t nextOffset = offset + mapSize;
+        size_t nextMapSize = 0;
+        const char *nextSegment = NULL;
+        if (nextOffset < fileSize) {
+            nextMapSize = (fileSize - nextOffset < READ_SIZE) ? fileSize - nextOffset : READ_SIZE;
+            nextSegment = mapRawContentFromDisk(file, nextMapSize, nextOffset);
+            prefetchRawContent(nextSegment, nextMapSize);
+        }
+        for (int threadIndex = 0; threadIndex < PARSER_THREAD_COUNT; threadIndex++) {
+            pthread_join(threads[threadIndex], NULL);
+        }
+        // Hash tables hold copies of the words, so the segment can be unmapped before its runs are written
+        if (munmap((void *)segment, mapSize) == -1) {
+            printf("Error unmapping file!\n");
         }
-        // Write the hash table as intermediate results to disk
-        char *outputFileName = (char *)malloc(20);
-        sprintf(outputFileName, "Intermediate%d.bin", fileNumber);
-        fileNumber++;
-        writeHashTableToDisk(table, outputFileName);
-        // Clean up and prepare for next segment
-        freeHashTable(table);
-        offset += mapSize;
-        free(buffer);
+        segment = nextSegment;
+        mapSize = nextMapSize;
+        offset = nextOffset;
     }
+    free(carriedLine);
+    // Wait for the remaining runs to be written
+    freeRunWriter(writer);
+    // Write the vocabulary once all term ids are assigned
+    writeVocabularyToDisk(vocabulary);
+    freeVocabulary(vocabulary);
     fclose(file);
     // Write document lengths to disk
     writeDocLengthsToDisk(docLengths);
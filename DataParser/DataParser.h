@@ -3,17 +3,36 @@
 #define DATA_PARSER_H
 
 #include "HashTable.h"
+#include "RunWriter.h"
 #include <stdio.h>
 
 /* Buffer size for reading the dataset from disk (384MB) */
 #define READ_SIZE (384 * 1024 * 1024)
 /* Total number of documents in the collection.tsv dataset, hardcoded */
 #define DOC_COUNT 8841822
+/* Number of worker threads parsing each segment, each writes its own intermediate file, so segments * threads files are written in total */
+#define PARSER_THREAD_COUNT 4
+/* Number of hash tables in the pool, two per worker so a segment is parsed while the previous one is written */
+#define PARSER_TABLE_COUNT (2 * PARSER_THREAD_COUNT)
+
+/* Part of a segment parsed by one worker thread, a range of complete lines */
+typedef struct ParserTask {
+    const char *contentStart;   // First byte of the range, at the start of a line
+    const char *contentEnd; // End of the range (exclusive), right after a newline or at the end of the file
+    HashTable *table;   // Hash table taken from the run writer pool for this range
+    RunWriter *writer;  // Run writer the filled hash table is handed to
+    int *docLengths;    // Shared document lengths, each document is written by the single worker parsing its line
+    char outputFileName[20];    // Intermediate file written by the worker
+} ParserTask;
 
 /* Function prototypes */
-char *mapRawContentFromDisk(FILE *file, size_t mapSize, size_t offset, char *remainingContent); // Map raw file content to memory
-void writeHashTableToDisk(const HashTable *table, const char *outputFileName);  // Write hash table to binary file
+const char *mapRawContentFromDisk(FILE *file, size_t mapSize, size_t offset);   // Map raw file content to memory, read-only
+void prefetchRawContent(const char *content, size_t mapSize); // Start reading mapped content from disk in the background
+void appendToCarriedLine(char **line, size_t *lineLength, const char *content, size_t length);  // Append bytes to a line split by a segment boundary
+void writeHashTableToDisk(const HashTable *table, Vocabulary *vocabulary, const char *outputFileName);  // Write hash table to binary file with words replaced by term ids
 void writeDocLengthsToDisk(const int *docLengths);  // Write document lengths to binary file
+void parseLines(const char *contentStart, const char *contentEnd, HashTable *table, int *docLengths);   // Parse a range of complete lines into a hash table
+void *parserWorker(void *arg);  // Worker thread parsing a range of lines and queueing it as an intermediate file
 void parseData();  // Parse input data file and create intermediate binary files
 
 #endif
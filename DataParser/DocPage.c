@@ -89,20 +89,36 @@ char *getDocumentByDocId(int docId) {
     sqlite3 *db;
     if (sqlite3_open("collection.db", &db) != SQLITE_OK) {
         printf("Cannot open database %s: %s\n", "collection.db", sqlite3_errmsg(db));
+        sqlite3_close(db);
         return NULL;
     }
     sqlite3_stmt *stmt;
     const char *sql = "SELECT content FROM documents WHERE doc_id = ?;";
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
         printf("Error preparing statement\n");
+        sqlite3_close(db);
         return NULL;
     }
+    char *docContent = getDocumentByDocIdWithStatement(stmt, docId);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return docContent;
+}
+
+/**
+ * Retrieves document content by docId using an already prepared statement
+ * The statement is reset afterwards so it can be reused for the next lookup
+ * @param stmt Prepared "SELECT content FROM documents WHERE doc_id = ?" statement
+ * @param docId Document ID to retrieve
+ */
+char *getDocumentByDocIdWithStatement(sqlite3_stmt *stmt, int docId) {
     sqlite3_bind_int(stmt, 1, docId);
     char *docContent = NULL;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         const char *text = (char*)sqlite3_column_text(stmt, 0);
         docContent = strdup(text);
     }
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
     return docContent;
 }
@@ -9,5 +9,6 @@
 sqlite3* initDatabase();    // Initialize sqlite3 database
 bool loadDocuments(sqlite3 *db);    // Load documents from disk to sqlite3 database
 char *getDocumentByDocId(int docId);    // Get document by docId from sqlite3 database
+char *getDocumentByDocIdWithStatement(sqlite3_stmt *stmt, int docId);   // Get document by docId using an already prepared statement
 
 #endif
@@ -5,58 +5,91 @@
 #include <string.h>
 
 /**
- * Adds a new node to the linked list
- * @param list Linked list to add to
- * @param docId Document ID for the new node
- */
-void addLinkedListNode(LinkedList *list, const int docId) {
-    LinkedListNode *newNode = (LinkedListNode *)malloc(sizeof(LinkedListNode));
-    newNode->docId = docId;
-    newNode->frequency = 1;
-    newNode->next = NULL;
-    // Add to empty list or append to existing list
-    if (list->nodeCount == 0) {
-        list->headNode = newNode;
-        list->tailNode = newNode;
-    } else {
-        list->tailNode->next = newNode;
-        list->tailNode = newNode;
+ * Adds a new posting to the posting list, starting a new block with doubled capacity when the tail block is full
+ * @param arena Arena to allocate blocks from
+ * @param list Posting list to add to
+ * @param docId Document ID for the new posting
+ */
+void addPosting(MemoryArena *arena, PostingList *list, const int docId) {
+    PostingBlock *block = list->tailBlock;
+    if (block == NULL || block->postingCount == block->capacity) {
+        int capacity = (block == NULL) ? INITIAL_POSTING_BLOCK_CAPACITY : block->capacity * 2;
+        if (capacity > MAX_POSTING_BLOCK_CAPACITY) {
+            capacity = MAX_POSTING_BLOCK_CAPACITY;
+        }
+        // Allocate block header and both arrays in one piece
+        PostingBlock *newBlock = (PostingBlock *)arenaAllocate(arena, sizeof(PostingBlock) + 2 * capacity * sizeof(int));
+        newBlock->postingCount = 0;
+        newBlock->capacity = capacity;
+        newBlock->next = NULL;
+        newBlock->docIds = (int *)(newBlock + 1);
+        newBlock->frequencies = newBlock->docIds + capacity;
+        // Add to empty list or append to existing list
+        if (block == NULL) {
+            list->headBlock = newBlock;
+        } else {
+            block->next = newBlock;
+        }
+        list->tailBlock = newBlock;
+        block = newBlock;
     }
-    list->nodeCount++;
+    block->docIds[block->postingCount] = docId;
+    block->frequencies[block->postingCount] = 1;
+    block->postingCount++;
+    list->postingCount++;
 }
 
 /**
- * Updates frequency if document exists in list, otherwise adds new node
- * @param list Linked list to update
+ * Updates frequency if document is the last one in the list, otherwise adds new posting
+ * @param arena Arena to allocate blocks from
+ * @param list Posting list to update
  * @param docId Document ID to update/add
  */
-void updateLinkedList(LinkedList *list, const int docId) {
-    LinkedListNode *currentNode = list->tailNode;
-    // If same document as last node, increment frequency
-    if (currentNode->docId == docId) {
-        currentNode->frequency += 1;
+void updatePostingList(MemoryArena *arena, PostingList *list, const int docId) {
+    PostingBlock *block = list->tailBlock;
+    // If same document as last posting, increment frequency
+    if (block->docIds[block->postingCount - 1] == docId) {
+        block->frequencies[block->postingCount - 1] += 1;
         return;
     }
-    // Otherwise add new node
-    addLinkedListNode(list, docId);
+    // Otherwise add new posting
+    addPosting(arena, list, docId);
 }
 
 /**
- * Calculates hash value for a word string using the DJB2 algorithm
- * @param word Input word string to be hashed
- * @return Computed hash value (modulo table size)
+ * Calculates the full hash value of a word using FNV-1a followed by a final avalanche mix,
+ * so that the low bits used as slot index depend on every character
+ * @param word Input word, does not need to be null-terminated
+ * @param wordLength Length of the word
+ * @return Computed 32-bit hash value
  */
-int hashFunction (const char *word) {
-    int hash = 5381;    // Initial value for DJB2 algorithm
-    for (int i = 0; word[i] != '\0'; i++) {
-        hash = ((hash << 5) + hash) + word[i];  // hash * 33 + c
+uint32_t hashFunction(const char *word, int wordLength) {
+    uint32_t hash = 2166136261u;    // FNV offset basis
+    for (int i = 0; i < wordLength; i++) {
+        hash ^= (unsigned char)word[i];
+        hash *= 16777619u;  // FNV prime
     }
-    int result = hash % HASHTABLE_SLOT_SIZE;
-    // Handle negative hash values
-    if (result < 0) {
-        result += HASHTABLE_SLOT_SIZE;
+    // Final mix from MurmurHash3
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/**
+ * Allocates an array of empty slots
+ * @param slotCount Number of slots
+ * @return Pointer to the zeroed slot array
+ */
+HashTableSlot *createHashTableSlots(int slotCount) {
+    HashTableSlot *slots = (HashTableSlot *)calloc(slotCount, sizeof(HashTableSlot));
+    if (slots == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
     }
-    return result;
+    return slots;
 }
 
 /**
@@ -70,7 +103,10 @@ HashTable *createHashTable() {
         exit(1);
     }
     newTable->wordCount = 0;
-    memset(newTable->slots, 0, sizeof(HashTableEntry *) * HASHTABLE_SLOT_SIZE);
+    newTable->slotCount = HASHTABLE_INITIAL_SLOT_COUNT;
+    newTable->maxWordCount = (int)(HASHTABLE_INITIAL_SLOT_COUNT * HASHTABLE_MAX_LOAD_FACTOR);
+    newTable->arena = createArena(ARENA_BLOCK_SIZE);
+    newTable->slots = createHashTableSlots(newTable->slotCount);
     return newTable;
 }
 
@@ -79,95 +115,227 @@ HashTable *createHashTable() {
  * @param table Pointer to the hash table to be freed
  */
 void freeHashTable(HashTable *table) {
-    for (int slotIndex = 0; slotIndex < HASHTABLE_SLOT_SIZE; slotIndex++) {
-        HashTableEntry *currentEntry = table->slots[slotIndex];
-        while (currentEntry != NULL) {
-            HashTableEntry *tempEntry = currentEntry;
-            currentEntry = currentEntry->next;
-            free(tempEntry->word);
-            // Free the linked list nodes
-            LinkedListNode *currentNode = tempEntry->list->headNode;
-            while (currentNode != NULL) {
-                LinkedListNode *tempNode = currentNode;
-                currentNode = currentNode->next;
-                free(tempNode);
-            }
-            free(tempEntry->list);
-            free(tempEntry);
+    freeArena(table->arena);
+    free(table->slots);
+    free(table);
+}
+
+/**
+ * Removes all entries from the hash table at once
+ * Entries, words and postings are released by a single arena reset, the arena's blocks and the grown slot array are kept for the next segment
+ * @param table Hash table to reset
+ */
+void resetHashTable(HashTable *table) {
+    resetArena(table->arena);
+    table->wordCount = 0;
+    memset(table->slots, 0, sizeof(HashTableSlot) * table->slotCount);
+}
+
+/**
+ * Moves all entries into a slot array of a new size
+ * Slots are placed by their cached hashes, so no word is hashed or compared again
+ * @param table Hash table to resize
+ * @param slotCount New number of slots, a power of two larger than the word count
+ */
+void resizeHashTable(HashTable *table, int slotCount) {
+    HashTableSlot *slots = createHashTableSlots(slotCount);
+    uint32_t mask = (uint32_t)slotCount - 1;
+    for (int slotIndex = 0; slotIndex < table->slotCount; slotIndex++) {
+        if (table->slots[slotIndex].entry == NULL) {
+            continue;
+        }
+        uint32_t newSlotIndex = table->slots[slotIndex].hash & mask;
+        while (slots[newSlotIndex].entry != NULL) {
+            newSlotIndex = (newSlotIndex + 1) & mask;
         }
+        slots[newSlotIndex] = table->slots[slotIndex];
     }
-    free(table);
+    free(table->slots);
+    table->slots = slots;
+    table->slotCount = slotCount;
+    table->maxWordCount = (int)(slotCount * HASHTABLE_MAX_LOAD_FACTOR);
 }
 
 /**
- * Adds a new entry to the hash table
+ * Adds a new entry to an empty slot of the hash table
  * @param table Hash table to add to
- * @param word Word to be added
+ * @param slot Empty slot ending the probe sequence of the word
+ * @param word Word to be added, does not need to be null-terminated
+ * @param wordLength Length of the word
+ * @param hash Full hash of the word
  * @param docId Document ID where the word appears
  */
-void addHashTableEntry(HashTable *table, const char *word, const int docId) {
-    int slotIndex = hashFunction(word);
-    // Create new linked list for the entry
-    LinkedList *newList = (LinkedList *)malloc(sizeof(LinkedList));
-    newList->nodeCount = 0;
-    newList->headNode = NULL;
-    newList->tailNode = NULL;
-    addLinkedListNode(newList, docId);
-    // Create and initialize new hash table entry
-    HashTableEntry *newEntry = (HashTableEntry *)malloc(sizeof(HashTableEntry));
-    newEntry->wordLength = (int)strlen(word);
-    newEntry->word = (char *)malloc(strlen(word) + 1);
-    strcpy(newEntry->word, word);
-    // Add to front of the chain at the computed slot
-    newEntry->list = newList;
-    newEntry->next = table->slots[slotIndex];
-    table->slots[slotIndex] = newEntry;
+void addHashTableEntry(HashTable *table, HashTableSlot *slot, const char *word, int wordLength, uint32_t hash, const int docId) {
+    // Create and initialize new hash table entry, interning the word in the arena
+    HashTableEntry *newEntry = (HashTableEntry *)arenaAllocate(table->arena, sizeof(HashTableEntry));
+    newEntry->wordLength = wordLength;
+    newEntry->word = arenaCopyString(table->arena, word, wordLength);
+    // Create new posting list for the entry
+    newEntry->list.postingCount = 0;
+    newEntry->list.headBlock = NULL;
+    newEntry->list.tailBlock = NULL;
+    addPosting(table->arena, &newEntry->list, docId);
+    // Occupy the slot
+    slot->hash = hash;
+    slot->wordLength = wordLength;
+    slot->entry = newEntry;
     table->wordCount++;
 }
 
 /**
  * Updates existing entry or adds new entry to hash table
+ * Probes linearly from the word's home slot, comparing cached hashes and lengths before the strings
  * @param table Hash table to update
- * @param word Word to be updated/added
+ * @param word Word to be updated/added, does not need to be null-terminated
+ * @param wordLength Length of the word
  * @param docId Document ID where the word appears
  */
-void updateHashTable(HashTable *table, const char *word, const int docId) {
-    int slotIndex = hashFunction(word);
-    // Search for existing entry in the chain
-    HashTableEntry *currentEntry = table->slots[slotIndex];
-    while (currentEntry != NULL) {
-        if (strcmp(currentEntry->word, word) == 0) {
-            updateLinkedList(currentEntry->list, docId);
+void updateHashTable(HashTable *table, const char *word, int wordLength, const int docId) {
+    uint32_t hash = hashFunction(word, wordLength);
+    uint32_t mask = (uint32_t)table->slotCount - 1;
+    uint32_t slotIndex = hash & mask;
+    // Search for existing entry along the probe sequence
+    while (table->slots[slotIndex].entry != NULL) {
+        HashTableSlot *slot = &table->slots[slotIndex];
+        if (slot->hash == hash && slot->wordLength == wordLength && memcmp(slot->entry->word, word, wordLength) == 0) {
+            updatePostingList(table->arena, &slot->entry->list, docId);
             return;
         }
-        currentEntry = currentEntry->next;
+        slotIndex = (slotIndex + 1) & mask;
     }
-    // If not found, add new entry
-    addHashTableEntry(table, word, docId);
+    // Grow before inserting so that probe sequences stay short, then find the empty slot again
+    if (table->wordCount + 1 > table->maxWordCount) {
+        resizeHashTable(table, table->slotCount * 2);
+        mask = (uint32_t)table->slotCount - 1;
+        slotIndex = hash & mask;
+        while (table->slots[slotIndex].entry != NULL) {
+            slotIndex = (slotIndex + 1) & mask;
+        }
+    }
+    // If not found, add new entry in the empty slot ending the probe sequence
+    addHashTableEntry(table, &table->slots[slotIndex], word, wordLength, hash, docId);
 }
 
-int compare(const void *a, const void *b) {
-    return strcmp(*(const char **)a, *(const char **)b);
+/**
+ * Finds the entry of a word in the hash table
+ * @param table Hash table to search
+ * @param word Word to find, does not need to be null-terminated
+ * @param wordLength Length of the word
+ * @return Entry of the word or NULL if not found
+ */
+HashTableEntry *findHashTableEntry(const HashTable *table, const char *word, int wordLength) {
+    uint32_t hash = hashFunction(word, wordLength);
+    uint32_t mask = (uint32_t)table->slotCount - 1;
+    uint32_t slotIndex = hash & mask;
+    while (table->slots[slotIndex].entry != NULL) {
+        const HashTableSlot *slot = &table->slots[slotIndex];
+        if (slot->hash == hash && slot->wordLength == wordLength && memcmp(slot->entry->word, word, wordLength) == 0) {
+            return slot->entry;
+        }
+        slotIndex = (slotIndex + 1) & mask;
+    }
+    return NULL;
 }
 
 /**
- * Returns an array of all words in the hash table, sorted alphabetically
- * @param table Hash table to extract words from
- * @return Array of pointers to words
+ * Returns the byte of a word at the given depth, 0 past its end
+ * @param entry Entry holding the word
+ * @param depth Position in the word
+ * @return Byte at the depth as an unsigned value, so the order matches strcmp
  */
-char **getSortedWordsFromHashTable(const HashTable *table) {
-    char **words = (char **)malloc(sizeof(char *) * table->wordCount);
-    int wordIndex = 0;
-    // Collect all words from the hash table
-    for (int slotIndex = 0; slotIndex < HASHTABLE_SLOT_SIZE; slotIndex++) {
-        HashTableEntry *currentEntry = table->slots[slotIndex];
-        while (currentEntry != NULL) {
-            words[wordIndex] = currentEntry->word;
-            wordIndex++;
-            currentEntry = currentEntry->next;
+int getEntryCharacter(const HashTableEntry *entry, int depth) {
+    return (depth < entry->wordLength) ? (unsigned char)entry->word[depth] : 0;
+}
+
+/**
+ * Swaps two entries of an array
+ * @param entries Array of entries
+ * @param i Index of the first entry
+ * @param j Index of the second entry
+ */
+void swapEntries(HashTableEntry **entries, int i, int j) {
+    HashTableEntry *temp = entries[i];
+    entries[i] = entries[j];
+    entries[j] = temp;
+}
+
+/**
+ * Sorts a small array of entries whose words share their first depth bytes
+ * @param entries Array of entries
+ * @param entryCount Number of entries
+ * @param depth Number of leading bytes all words share
+ */
+void insertionSortEntries(HashTableEntry **entries, int entryCount, int depth) {
+    for (int i = 1; i < entryCount; i++) {
+        HashTableEntry *entry = entries[i];
+        int j = i;
+        while (j > 0 && strcmp(entries[j - 1]->word + depth, entry->word + depth) > 0) {
+            entries[j] = entries[j - 1];
+            j--;
+        }
+        entries[j] = entry;
+    }
+}
+
+/**
+ * Sorts entries by word with multikey quicksort
+ * Partitions three ways on a single byte, so shared prefixes are compared once instead of on every strcmp
+ * @param entries Array of entries
+ * @param entryCount Number of entries
+ * @param depth Number of leading bytes all words share
+ */
+void multikeyQuicksortEntries(HashTableEntry **entries, int entryCount, int depth) {
+    while (entryCount > SORT_INSERTION_THRESHOLD) {
+        // Median of three pivot
+        int a = getEntryCharacter(entries[0], depth);
+        int b = getEntryCharacter(entries[entryCount / 2], depth);
+        int c = getEntryCharacter(entries[entryCount - 1], depth);
+        int pivot = (a < b) ? ((b < c) ? b : ((a < c) ? c : a)) : ((a < c) ? a : ((b < c) ? c : b));
+        // Partition into bytes less than, equal to and greater than the pivot
+        int lessEnd = 0, index = 0, greaterStart = entryCount;
+        while (index < greaterStart) {
+            int character = getEntryCharacter(entries[index], depth);
+            if (character < pivot) {
+                swapEntries(entries, lessEnd++, index++);
+            } else if (character > pivot) {
+                swapEntries(entries, index, --greaterStart);
+            } else {
+                index++;
+            }
+        }
+        multikeyQuicksortEntries(entries, lessEnd, depth);
+        multikeyQuicksortEntries(entries + greaterStart, entryCount - greaterStart, depth);
+        // Words equal up to their end are identical, otherwise continue on the next byte
+        if (pivot == 0) {
+            return;
+        }
+        entries += lessEnd;
+        entryCount = greaterStart - lessEnd;
+        depth++;
+    }
+    insertionSortEntries(entries, entryCount, depth);
+}
+
+/**
+ * Returns an array of all entries in the hash table, sorted alphabetically by word
+ * The postings are reached straight from the sorted entries, no word is looked up again
+ * @param table Hash table to extract entries from
+ * @return Array of pointers to entries, caller must free
+ */
+HashTableEntry **getSortedEntriesFromHashTable(const HashTable *table) {
+    HashTableEntry **entries = (HashTableEntry **)malloc(sizeof(HashTableEntry *) * (table->wordCount + 1));
+    if (entries == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    int entryIndex = 0;
+    // Collect all entries from the hash table
+    for (int slotIndex = 0; slotIndex < table->slotCount; slotIndex++) {
+        if (table->slots[slotIndex].entry != NULL) {
+            entries[entryIndex] = table->slots[slotIndex].entry;
+            entryIndex++;
         }
     }
-    // Sort words alphabetically using quicksort
-    qsort(words, wordIndex, sizeof(char *), compare);
-    return words;
+    multikeyQuicksortEntries(entries, entryIndex, 0);
+    return entries;
 }
@@ -2,45 +2,75 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
-/* Size of hash table slots, chosen as a prime number to minimize collisions */
-#define HASHTABLE_SLOT_SIZE 400009
-
-/* Node structure for storing document occurrence information */
-typedef struct LinkedListNode {
-    int docId;  // Document identifier
-    int frequency;  // Number of occurrences in the document
-    struct LinkedListNode *next;    // Pointer to the next node
-} LinkedListNode;
-
-/* Linked list structure for managing document occurrence information */
-typedef struct LinkedList {
-    int nodeCount;  // Number of nodes in the linked list
-    LinkedListNode *headNode;   // Pointer to the head node
-    LinkedListNode *tailNode;   // Pointer to the tail node
-} LinkedList;
+#include "MemoryArena.h"
+#include <stdint.h>
+
+/* Initial number of hash table slots, a power of two so that slot indices are taken with a mask */
+#define HASHTABLE_INITIAL_SLOT_COUNT (1 << 19)
+/* Maximum ratio of words to slots, the slot array doubles when an insertion would exceed it */
+#define HASHTABLE_MAX_LOAD_FACTOR 0.7
+/* Partitions of at most this many entries are sorted by insertion sort */
+#define SORT_INSERTION_THRESHOLD 16
+/* Capacity of the first posting block of a word, most words occur in few documents */
+#define INITIAL_POSTING_BLOCK_CAPACITY 2
+/* Capacity limit of posting blocks, capacity doubles with each new block up to this limit */
+#define MAX_POSTING_BLOCK_CAPACITY 4096
+
+/* Block of postings in a posting list, docIds and frequencies are stored in separate contiguous arrays */
+typedef struct PostingBlock {
+    int postingCount;   // Number of postings in the block
+    int capacity;   // Maximum number of postings in the block
+    struct PostingBlock *next;  // Pointer to the next block
+    int *docIds;    // Document identifiers
+    int *frequencies;   // Number of occurrences in the corresponding documents
+} PostingBlock;
+
+/* Posting list of a word, a chain of blocks with growing capacity allocated from the hash table's arena */
+typedef struct PostingList {
+    int postingCount;   // Number of postings in the list
+    PostingBlock *headBlock;    // Pointer to the head block
+    PostingBlock *tailBlock;    // Pointer to the tail block
+} PostingList;
 
 /* Hash table entry structure for storing words and their occurrences */
 typedef struct HashTableEntry {
     int wordLength; // Length of the word
-    char *word; // The word string
-    LinkedList *list;   // Linked list storing document IDs and frequencies
-    struct HashTableEntry *next;    // Pointer to the next entry for handling hash collisions in the slot
+    char *word; // The word string, interned in the hash table's arena
+    PostingList list;   // Posting list storing document IDs and frequencies
 } HashTableEntry;
 
-/* Hash table structure for storing word entries */
+/* Slot of the open addressing table, caches hash and length of its word so that most mismatches never touch the string */
+typedef struct HashTableSlot {
+    uint32_t hash;  // Full hash of the word
+    int wordLength; // Length of the word
+    HashTableEntry *entry;  // Entry of the word, NULL if the slot is empty
+} HashTableSlot;
+
+/* Resizable open addressing hash table with linear probing, all entries, words and postings live in one arena released at once */
 typedef struct HashTable {
     int wordCount;  // Number of unique words in the hash table
-    HashTableEntry *slots[HASHTABLE_SLOT_SIZE];   // Array of hash table slots for storing word entries
+    int slotCount;  // Number of slots, always a power of two
+    int maxWordCount;   // Number of words allowed before the slot array has to grow
+    MemoryArena *arena; // Arena holding entries, words and posting blocks
+    HashTableSlot *slots;   // Array of hash table slots for storing word entries
 } HashTable;
 
 /* Function prototypes */
-void addLinkedListNode(LinkedList *list, const int docId);  // Add a new node to the linked list
-void updateLinkedList(LinkedList *list, const int docId);   // Update the linked list with document occurrence information
-int hashFunction(const char *word); // Hash function for generating slot index from a word
+void addPosting(MemoryArena *arena, PostingList *list, const int docId);    // Add a new posting to the posting list
+void updatePostingList(MemoryArena *arena, PostingList *list, const int docId); // Update the posting list with document occurrence information
+uint32_t hashFunction(const char *word, int wordLength);    // Hash function for generating the full hash of a word
+HashTableSlot *createHashTableSlots(int slotCount); // Allocate an array of empty slots
 HashTable *createHashTable();   // Create a new hash table
 void freeHashTable(HashTable *table);   // Free the memory allocated for the hash table
-void addHashTableEntry(HashTable *table, const char *word, const int docId);    // Add a new word entry to the hash table
-void updateHashTable(HashTable *table, const char *word, const int docId);  // Update an existing word entry or add a new one in the hash table
-char **getSortedWordsFromHashTable(const HashTable *table); // Get an array of sorted words from the hash table
+void resetHashTable(HashTable *table);  // Remove all entries at once, keeping memory for reuse
+void resizeHashTable(HashTable *table, int slotCount);  // Move all entries into a slot array of a new size
+void addHashTableEntry(HashTable *table, HashTableSlot *slot, const char *word, int wordLength, uint32_t hash, const int docId);  // Add a new word entry to an empty slot of the hash table
+void updateHashTable(HashTable *table, const char *word, int wordLength, const int docId);  // Update an existing word entry or add a new one in the hash table
+HashTableEntry *findHashTableEntry(const HashTable *table, const char *word, int wordLength);  // Find the entry of a word in the hash table
+int getEntryCharacter(const HashTableEntry *entry, int depth);  // Get the byte of a word at a depth, 0 past its end
+void swapEntries(HashTableEntry **entries, int i, int j);   // Swap two entries of an array
+void insertionSortEntries(HashTableEntry **entries, int entryCount, int depth); // Sort a small array of entries sharing a prefix
+void multikeyQuicksortEntries(HashTableEntry **entries, int entryCount, int depth);  // Sort entries by word with multikey quicksort
+HashTableEntry **getSortedEntriesFromHashTable(const HashTable *table); // Get an array of entries sorted by word from the hash table
 
 #endif
@@ -0,0 +1,58 @@
+/* IntermediateRun.c */
+#include "IntermediateRun.h"
+
+/**
+ * Computes the number of bytes of a VByte encoded value
+ * @param value Value to encode
+ * @return Number of bytes encodeVarByte writes for the value, same as computeVarByteLength of the inverted index
+ */
+int computeVarByteSize(uint32_t value) {
+    int byteCount = 1;
+    while (value >= 128) {
+        value >>= 7;
+        byteCount++;
+    }
+    return byteCount;
+}
+
+/**
+ * Encodes a value with VByte encoding, 7 bits per byte with the highest bit set on every byte but the last
+ * Uses the same byte order as the inverted index, least significant group first
+ * @param value Value to encode
+ * @param bytes Buffer of at least MAX_VARBYTE_LENGTH bytes
+ * @return Number of bytes written
+ */
+size_t encodeVarByte(uint32_t value, uint8_t *bytes) {
+    size_t byteCount = 0;
+    while (value >= 128) {
+        bytes[byteCount++] = (uint8_t)((value & 127) | 128);
+        value >>= 7;
+    }
+    bytes[byteCount++] = (uint8_t)value;
+    return byteCount;
+}
+
+/**
+ * Decodes a VByte value and advances the cursor past it
+ * The cursor is left untouched when the value is cut off, so a partially read file can be resumed once more content is available
+ * @param cursor Pointer to the current position, advanced on success
+ * @param end End of the available content (exclusive)
+ * @param value Pointer to store the decoded value
+ * @return true if a complete value was decoded, false otherwise
+ */
+bool decodeVarByte(const uint8_t **cursor, const uint8_t *end, uint32_t *value) {
+    const uint8_t *position = *cursor;
+    uint32_t result = 0;
+    int shift = 0;
+    while (position < end && shift < 7 * MAX_VARBYTE_LENGTH) {
+        uint8_t byte = *position++;
+        result |= (uint32_t)(byte & 127) << shift;
+        if (byte < 128) {
+            *value = result;
+            *cursor = position;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
@@ -0,0 +1,29 @@
+/* IntermediateRun.h */
+#ifndef INTERMEDIATE_RUN_H
+#define INTERMEDIATE_RUN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Compressed format of the intermediate files written by DataParser and merged by IndexBuilder
+ * Words are written in sorted order, each one as:
+ * 1. VByte term id of the word in the global vocabulary, see Vocabulary.h
+ * 2. VByte number of postings
+ * 3. VByte byte length of the docId gaps
+ * 4. VByte byte length of the frequencies
+ * 5. VByte docId gaps, the first one relative to 0
+ * 6. VByte frequencies
+ * The byte lengths let a reader point into the postings of a word, or skip them, without decoding them
+ */
+
+/* Maximum number of bytes of a VByte encoded 32-bit value */
+#define MAX_VARBYTE_LENGTH 5
+
+/* Function prototypes */
+int computeVarByteSize(uint32_t value); // Compute the number of bytes of a VByte encoded value
+size_t encodeVarByte(uint32_t value, uint8_t *bytes);  // Encode a value with VByte encoding, return the number of bytes written
+bool decodeVarByte(const uint8_t **cursor, const uint8_t *end, uint32_t *value);   // Decode a VByte value and advance the cursor, false if the value is cut off by end
+
+#endif
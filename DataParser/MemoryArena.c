@@ -0,0 +1,103 @@
+/* MemoryArena.c */
+#include "MemoryArena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Creates a new block of at least the requested size
+ * @param size Usable bytes in the block
+ * @return Pointer to the newly created block
+ */
+ArenaBlock *createArenaBlock(size_t size) {
+    ArenaBlock *block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + size);
+    if (block == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    block->size = size;
+    block->used = 0;
+    block->next = NULL;
+    return block;
+}
+
+/**
+ * Creates and initializes a new memory arena with a single block
+ * @param blockSize Size of each block, larger allocations get a block of their own
+ * @return Pointer to the newly created arena
+ */
+MemoryArena *createArena(size_t blockSize) {
+    MemoryArena *arena = (MemoryArena *)malloc(sizeof(MemoryArena));
+    if (arena == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    arena->blockSize = blockSize;
+    arena->headBlock = createArenaBlock(blockSize);
+    arena->currentBlock = arena->headBlock;
+    return arena;
+}
+
+/**
+ * Frees the arena with all its blocks
+ * @param arena Arena to be freed
+ */
+void freeArena(MemoryArena *arena) {
+    ArenaBlock *currentBlock = arena->headBlock;
+    while (currentBlock != NULL) {
+        ArenaBlock *tempBlock = currentBlock;
+        currentBlock = currentBlock->next;
+        free(tempBlock);
+    }
+    free(arena);
+}
+
+/**
+ * Releases all allocations at once
+ * Blocks are kept and handed out again in order, so a reused arena stops calling malloc once it has grown large enough
+ * @param arena Arena to reset
+ */
+void resetArena(MemoryArena *arena) {
+    arena->currentBlock = arena->headBlock;
+    arena->currentBlock->used = 0;
+}
+
+/**
+ * Allocates memory from the arena by bumping the offset of the current block
+ * @param arena Arena to allocate from
+ * @param size Number of bytes to allocate
+ * @return Pointer to memory aligned to ARENA_ALIGNMENT, valid until the arena is reset or freed
+ */
+void *arenaAllocate(MemoryArena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    ArenaBlock *block = arena->currentBlock;
+    while (block->size - block->used < size) {
+        if (block->next == NULL || block->next->size < size) {
+            // Insert a new block, oversized requests get a block of their own
+            ArenaBlock *newBlock = createArenaBlock(size > arena->blockSize ? size : arena->blockSize);
+            newBlock->next = block->next;
+            block->next = newBlock;
+        }
+        // Move on to the next block, which may hold stale allocations from before a reset
+        block = block->next;
+        block->used = 0;
+    }
+    arena->currentBlock = block;
+    void *pointer = block->data + block->used;
+    block->used += size;
+    return pointer;
+}
+
+/**
+ * Copies a string into the arena
+ * @param arena Arena to allocate from
+ * @param string String to copy
+ * @param length Length of the string
+ * @return Null-terminated copy of the string
+ */
+char *arenaCopyString(MemoryArena *arena, const char *string, size_t length) {
+    char *copy = (char *)arenaAllocate(arena, length + 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
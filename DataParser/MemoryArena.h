@@ -0,0 +1,34 @@
+/* MemoryArena.h */
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include <stddef.h>
+
+/* Default size of each arena block (16MB) */
+#define ARENA_BLOCK_SIZE (16 * 1024 * 1024)
+/* Alignment of every allocation from an arena */
+#define ARENA_ALIGNMENT 8
+
+/* Block of memory handed out by an arena, blocks are chained and kept for reuse after a reset */
+typedef struct ArenaBlock {
+    size_t size;    // Usable bytes in the block
+    size_t used;    // Bytes already handed out
+    struct ArenaBlock *next;    // Next block in the chain
+    char data[];    // Memory handed out by the arena
+} ArenaBlock;
+
+/* Bump allocator, allocations are never freed individually but released all at once */
+typedef struct MemoryArena {
+    size_t blockSize;   // Size of newly created blocks
+    ArenaBlock *headBlock;  // First block in the chain
+    ArenaBlock *currentBlock;   // Block allocations are currently taken from
+} MemoryArena;
+
+/* Function prototypes */
+MemoryArena *createArena(size_t blockSize); // Create a new memory arena
+void freeArena(MemoryArena *arena); // Free the arena with all its blocks
+void resetArena(MemoryArena *arena);    // Release all allocations at once, keeping blocks for reuse
+void *arenaAllocate(MemoryArena *arena, size_t size);   // Allocate memory from the arena
+char *arenaCopyString(MemoryArena *arena, const char *string, size_t length);  // Copy a string into the arena
+
+#endif
@@ -0,0 +1,134 @@
+/* RunWriter.c */
+#include "RunWriter.h"
+#include "DataParser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Create the table pool and start the writer thread
+ * @param tableCount number of hash tables in the pool
+ * @param vocabulary global vocabulary assigning term ids to the written words
+ * @return pointer to the run writer
+ */
+RunWriter *createRunWriter(int tableCount, Vocabulary *vocabulary) {
+    RunWriter *writer = (RunWriter *)malloc(sizeof(RunWriter));
+    if (writer == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    writer->tableCount = tableCount;
+    writer->requests = (RunWriteRequest *)malloc(sizeof(RunWriteRequest) * tableCount);
+    writer->freeTables = (HashTable **)malloc(sizeof(HashTable *) * tableCount);
+    if (writer->requests == NULL || writer->freeTables == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    writer->requestHead = 0;
+    writer->requestCount = 0;
+    for (int i = 0; i < tableCount; i++) {
+        writer->freeTables[i] = createHashTable();
+    }
+    writer->freeTableCount = tableCount;
+    writer->vocabulary = vocabulary;
+    writer->isShuttingDown = false;
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->requestReady, NULL);
+    pthread_cond_init(&writer->tableReady, NULL);
+    if (pthread_create(&writer->thread, NULL, runWriterWorker, writer) != 0) {
+        printf("Error creating thread!\n");
+        exit(1);
+    }
+    return writer;
+}
+
+/**
+ * Write all queued tables, stop the writer thread and free the pool
+ * @param writer pointer to the run writer
+ */
+void freeRunWriter(RunWriter *writer) {
+    if (writer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&writer->mutex);
+    writer->isShuttingDown = true;
+    pthread_cond_signal(&writer->requestReady);
+    pthread_mutex_unlock(&writer->mutex);
+    pthread_join(writer->thread, NULL);
+    // Every table is back in the pool once the queue is drained
+    for (int i = 0; i < writer->freeTableCount; i++) {
+        freeHashTable(writer->freeTables[i]);
+    }
+    pthread_mutex_destroy(&writer->mutex);
+    pthread_cond_destroy(&writer->requestReady);
+    pthread_cond_destroy(&writer->tableReady);
+    free(writer->requests);
+    free(writer->freeTables);
+    free(writer);
+}
+
+/**
+ * Take an empty hash table from the pool, waiting while all are being written
+ * @param writer pointer to the run writer
+ * @return pointer to an empty hash table
+ */
+HashTable *acquireHashTable(RunWriter *writer) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->freeTableCount == 0) {
+        pthread_cond_wait(&writer->tableReady, &writer->mutex);
+    }
+    writer->freeTableCount--;
+    HashTable *table = writer->freeTables[writer->freeTableCount];
+    pthread_mutex_unlock(&writer->mutex);
+    return table;
+}
+
+/**
+ * Queue a filled hash table to be written in the background
+ * The queue holds at most one request per table, so it never overflows
+ * @param writer pointer to the run writer
+ * @param table hash table taken from the pool with acquireHashTable
+ * @param outputFileName intermediate file to write
+ */
+void submitRun(RunWriter *writer, HashTable *table, const char *outputFileName) {
+    pthread_mutex_lock(&writer->mutex);
+    RunWriteRequest *request = &writer->requests[(writer->requestHead + writer->requestCount) % writer->tableCount];
+    request->table = table;
+    strncpy(request->outputFileName, outputFileName, sizeof(request->outputFileName) - 1);
+    request->outputFileName[sizeof(request->outputFileName) - 1] = '\0';
+    writer->requestCount++;
+    pthread_cond_signal(&writer->requestReady);
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+/**
+ * Writer thread writing queued hash tables to disk
+ * Sorting and writing happen outside the lock, so workers keep filling other tables meanwhile
+ * @param arg pointer to the run writer
+ * @return NULL
+ */
+void *runWriterWorker(void *arg) {
+    RunWriter *writer = (RunWriter *)arg;
+    pthread_mutex_lock(&writer->mutex);
+    while (true) {
+        while (writer->requestCount == 0 && !writer->isShuttingDown) {
+            pthread_cond_wait(&writer->requestReady, &writer->mutex);
+        }
+        if (writer->requestCount == 0) {
+            break;
+        }
+        RunWriteRequest request = writer->requests[writer->requestHead];
+        writer->requestHead = (writer->requestHead + 1) % writer->tableCount;
+        writer->requestCount--;
+        pthread_mutex_unlock(&writer->mutex);
+        writeHashTableToDisk(request.table, writer->vocabulary, request.outputFileName);
+        resetHashTable(request.table);
+        pthread_mutex_lock(&writer->mutex);
+        // Return the emptied table to the pool
+        writer->freeTables[writer->freeTableCount] = request.table;
+        writer->freeTableCount++;
+        pthread_cond_signal(&writer->tableReady);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+    return NULL;
+}
@@ -0,0 +1,43 @@
+/* RunWriter.h */
+#ifndef RUN_WRITER_H
+#define RUN_WRITER_H
+
+#include "HashTable.h"
+#include "Vocabulary.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+/* Filled hash table waiting to be written as an intermediate file */
+typedef struct RunWriteRequest {
+    HashTable *table;   // Hash table holding the parsed range
+    char outputFileName[20];    // Intermediate file to write
+} RunWriteRequest;
+
+/**
+ * Background stage writing intermediate files
+ * Parser workers take empty hash tables from the pool and hand them back filled, the writer thread sorts and writes each one, resets it and returns it to the pool
+ * The pool is bounded, so a worker only waits when every table is still queued for writing
+ */
+typedef struct RunWriter {
+    pthread_t thread;   // Writer thread
+    pthread_mutex_t mutex;  // Protects the queue and the pool
+    pthread_cond_t requestReady;    // Signalled when a table is queued or the writer is shutting down
+    pthread_cond_t tableReady;  // Signalled when a table returns to the pool
+    int tableCount; // Number of hash tables in the pool, bounds the queue as well
+    RunWriteRequest *requests;  // Circular queue of tables to write, in submission order
+    int requestHead;    // Index of the oldest queued request
+    int requestCount;   // Number of queued requests
+    HashTable **freeTables; // Empty hash tables ready to be filled
+    int freeTableCount; // Number of empty hash tables
+    Vocabulary *vocabulary; // Global vocabulary assigning term ids, only used by the writer thread
+    bool isShuttingDown;    // Set once no more tables will be queued
+} RunWriter;
+
+/* Function prototypes */
+RunWriter *createRunWriter(int tableCount, Vocabulary *vocabulary);   // Create a pool of tableCount hash tables and start the writer thread
+void freeRunWriter(RunWriter *writer);  // Write all queued tables, stop the writer thread and free the pool
+HashTable *acquireHashTable(RunWriter *writer); // Take an empty hash table from the pool, waiting while all are being written
+void submitRun(RunWriter *writer, HashTable *table, const char *outputFileName);    // Queue a filled hash table to be written in the background
+void *runWriterWorker(void *arg);   // Writer thread writing queued hash tables to disk
+
+#endif
@@ -0,0 +1,156 @@
+/* Tokenizer.c */
+#include "Tokenizer.h"
+#include <string.h>
+
+#ifdef TOKENIZER_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Classifies a block one byte at a time, works on every CPU
+ * Matches isalnum in the C locale, bytes outside ASCII are never alphanumeric
+ * @param block TOKENIZER_BLOCK_SIZE bytes to classify
+ * @return Mask with bit i set if byte i is alphanumeric
+ */
+uint64_t classifyBlockScalar(const char *block) {
+    uint64_t mask = 0;
+    for (int i = 0; i < TOKENIZER_BLOCK_SIZE; i++) {
+        unsigned char c = (unsigned char)block[i];
+        unsigned char lower = c | 0x20;
+        if ((unsigned char)(c - '0') < 10 || (unsigned char)(lower - 'a') < 26) {
+            mask |= (uint64_t)1 << i;
+        }
+    }
+    return mask;
+}
+
+#ifdef TOKENIZER_X86
+/**
+ * Classifies a block 16 bytes per instruction with the SSE4.2 string range comparison
+ * Explicit lengths are used, so a NUL byte does not hide the bytes after it
+ * @param block TOKENIZER_BLOCK_SIZE bytes to classify
+ * @return Mask with bit i set if byte i is alphanumeric
+ */
+__attribute__((target("sse4.2")))
+uint64_t classifyBlockSse42(const char *block) {
+    const __m128i ranges = _mm_setr_epi8('0', '9', 'A', 'Z', 'a', 'z', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    uint64_t mask = 0;
+    for (int i = 0; i < TOKENIZER_BLOCK_SIZE; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(block + i));
+        __m128i matches = _mm_cmpestrm(ranges, 6, bytes, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK);
+        mask |= (uint64_t)(uint16_t)_mm_cvtsi128_si32(matches) << i;
+    }
+    return mask;
+}
+
+/**
+ * Classifies a block 32 bytes per instruction with AVX2 range checks,
+ * a byte is in [lo, hi] if the unsigned minimum of (byte - lo) and (hi - lo) is (byte - lo)
+ * @param block TOKENIZER_BLOCK_SIZE bytes to classify
+ * @return Mask with bit i set if byte i is alphanumeric
+ */
+__attribute__((target("avx2")))
+uint64_t classifyBlockAvx2(const char *block) {
+    const __m256i digitLow = _mm256_set1_epi8('0');
+    const __m256i digitSpan = _mm256_set1_epi8(9);
+    const __m256i letterLow = _mm256_set1_epi8('a');
+    const __m256i letterSpan = _mm256_set1_epi8(25);
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    uint64_t mask = 0;
+    for (int i = 0; i < TOKENIZER_BLOCK_SIZE; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)(block + i));
+        __m256i digitOffset = _mm256_sub_epi8(bytes, digitLow);
+        __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digitOffset, digitSpan), digitOffset);
+        __m256i letterOffset = _mm256_sub_epi8(_mm256_or_si256(bytes, caseBit), letterLow);
+        __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letterOffset, letterSpan), letterOffset);
+        mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) << i;
+    }
+    return mask;
+}
+#endif
+
+/**
+ * Gets the fastest block classifier supported by the CPU, AVX2 first, then SSE4.2, then the scalar fallback
+ * CPU features are detected by the runtime before main, so this only reads them
+ * @return Block classifier
+ */
+BlockClassifier getBlockClassifier() {
+#ifdef TOKENIZER_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return classifyBlockAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return classifyBlockSse42;
+    }
+#endif
+    return classifyBlockScalar;
+}
+
+/**
+ * Classifies the block starting at the scanner's block start
+ * A block reaching past the end of the range is copied into a zero-padded buffer first, so no byte past the end is read
+ * @param scanner Token scanner
+ * @return Mask with bit i set if byte i of the block is alphanumeric
+ */
+uint64_t classifyScannerBlock(const TokenScanner *scanner) {
+    size_t remainingLength = (size_t)(scanner->end - scanner->blockStart);
+    if (remainingLength >= TOKENIZER_BLOCK_SIZE) {
+        return scanner->classifier(scanner->blockStart);
+    }
+    char paddedBlock[TOKENIZER_BLOCK_SIZE] = {0};
+    memcpy(paddedBlock, scanner->blockStart, remainingLength);
+    return scanner->classifier(paddedBlock);
+}
+
+/**
+ * Starts scanning a range of bytes
+ * @param scanner Token scanner to initialize
+ * @param start First byte of the range
+ * @param end End of the range (exclusive)
+ */
+void initTokenScanner(TokenScanner *scanner, const char *start, const char *end) {
+    scanner->classifier = getBlockClassifier();
+    scanner->blockStart = start;
+    scanner->end = end;
+    scanner->alnumMask = (start < end) ? classifyScannerBlock(scanner) : 0;
+}
+
+/**
+ * Gets the next token of the range
+ * The start of a token is the lowest set bit of the block mask, its end the lowest clear bit above it,
+ * so scanning only touches bytes once per block rather than once per character
+ * @param scanner Token scanner
+ * @param tokenLength Pointer to store the length of the token
+ * @return Start of the token, NULL if the range has no more tokens
+ */
+const char *nextToken(TokenScanner *scanner, int *tokenLength) {
+    // Find the block holding the start of the next token
+    while (scanner->alnumMask == 0) {
+        scanner->blockStart += TOKENIZER_BLOCK_SIZE;
+        if (scanner->blockStart >= scanner->end) {
+            scanner->blockStart = scanner->end;
+            return NULL;
+        }
+        scanner->alnumMask = classifyScannerBlock(scanner);
+    }
+    int startBit = __builtin_ctzll(scanner->alnumMask);
+    const char *tokenStart = scanner->blockStart + startBit;
+    // Find the end of the token, possibly in a later block
+    uint64_t nonAlnumMask = ~scanner->alnumMask & (~(uint64_t)0 << startBit);
+    while (nonAlnumMask == 0) {
+        scanner->blockStart += TOKENIZER_BLOCK_SIZE;
+        if (scanner->blockStart >= scanner->end) {
+            scanner->blockStart = scanner->end;
+            scanner->alnumMask = 0;
+            *tokenLength = (int)(scanner->end - tokenStart);
+            return tokenStart;
+        }
+        scanner->alnumMask = classifyScannerBlock(scanner);
+        nonAlnumMask = ~scanner->alnumMask;
+    }
+    int endBit = __builtin_ctzll(nonAlnumMask);
+    // Consume the token, bits below its end are cleared
+    scanner->alnumMask &= ~(uint64_t)0 << endBit;
+    *tokenLength = (int)(scanner->blockStart + endBit - tokenStart);
+    return tokenStart;
+}
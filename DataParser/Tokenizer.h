@@ -0,0 +1,41 @@
+/* Tokenizer.h */
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Vectorized classifiers are built on x86, other CPUs use the scalar classifier */
+#if defined(__x86_64__) || defined(__i386__)
+#define TOKENIZER_X86 1
+#endif
+
+/* Number of bytes classified at once, one bit per byte in a block mask */
+#define TOKENIZER_BLOCK_SIZE 64
+
+/* Function classifying a block of TOKENIZER_BLOCK_SIZE bytes, bit i of the result is set if byte i is alphanumeric */
+typedef uint64_t (*BlockClassifier)(const char *block);
+
+/**
+ * Scanner producing tokens, i.e., maximal runs of ASCII alphanumeric characters, from a range of bytes
+ * Bytes are classified a block at a time, token boundaries are then read off the block mask with bit operations
+ */
+typedef struct TokenScanner {
+    BlockClassifier classifier; // Block classifier selected for the CPU
+    const char *blockStart; // Start of the current block
+    const char *end;    // End of the range (exclusive)
+    uint64_t alnumMask; // Alphanumeric bytes of the current block not consumed yet
+} TokenScanner;
+
+/* Function prototypes */
+uint64_t classifyBlockScalar(const char *block);    // Classify a block one byte at a time
+#ifdef TOKENIZER_X86
+uint64_t classifyBlockSse42(const char *block); // Classify a block 16 bytes per instruction with SSE4.2
+uint64_t classifyBlockAvx2(const char *block);  // Classify a block 32 bytes per instruction with AVX2
+#endif
+BlockClassifier getBlockClassifier();   // Get the fastest block classifier supported by the CPU
+uint64_t classifyScannerBlock(const TokenScanner *scanner); // Classify the current block of a scanner without reading past its range
+void initTokenScanner(TokenScanner *scanner, const char *start, const char *end);   // Start scanning a range of bytes
+const char *nextToken(TokenScanner *scanner, int *tokenLength); // Get the next token of the range
+
+#endif
@@ -0,0 +1,166 @@
+/* Vocabulary.c */
+#include "Vocabulary.h"
+#include "HashTable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Creates a new empty vocabulary
+ * @return Pointer to the newly created vocabulary
+ */
+Vocabulary *createVocabulary() {
+    Vocabulary *vocabulary = (Vocabulary *)malloc(sizeof(Vocabulary));
+    if (vocabulary == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    vocabulary->wordCount = 0;
+    vocabulary->wordCapacity = VOCABULARY_INITIAL_SLOT_COUNT;
+    vocabulary->slotCount = VOCABULARY_INITIAL_SLOT_COUNT;
+    vocabulary->maxWordCount = (int)(VOCABULARY_INITIAL_SLOT_COUNT * VOCABULARY_MAX_LOAD_FACTOR);
+    vocabulary->arena = createArena(ARENA_BLOCK_SIZE);
+    vocabulary->words = (char **)malloc(sizeof(char *) * vocabulary->wordCapacity);
+    vocabulary->wordLengths = (int *)malloc(sizeof(int) * vocabulary->wordCapacity);
+    if (vocabulary->words == NULL || vocabulary->wordLengths == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    vocabulary->slots = createVocabularySlots(vocabulary->slotCount);
+    return vocabulary;
+}
+
+/**
+ * Frees the vocabulary with all its words
+ * @param vocabulary Vocabulary to free
+ */
+void freeVocabulary(Vocabulary *vocabulary) {
+    if (vocabulary == NULL) {
+        return;
+    }
+    freeArena(vocabulary->arena);
+    free(vocabulary->words);
+    free(vocabulary->wordLengths);
+    free(vocabulary->slots);
+    free(vocabulary);
+}
+
+/**
+ * Allocates an array of empty slots
+ * @param slotCount Number of slots
+ * @return Array of slots, all marked empty
+ */
+VocabularySlot *createVocabularySlots(int slotCount) {
+    VocabularySlot *slots = (VocabularySlot *)malloc(sizeof(VocabularySlot) * slotCount);
+    if (slots == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int slotIndex = 0; slotIndex < slotCount; slotIndex++) {
+        slots[slotIndex].termId = -1;
+    }
+    return slots;
+}
+
+/**
+ * Moves all words into a slot array of a new size, using the cached hashes
+ * @param vocabulary Vocabulary to resize
+ * @param slotCount New number of slots, a power of two
+ */
+void resizeVocabulary(Vocabulary *vocabulary, int slotCount) {
+    VocabularySlot *slots = createVocabularySlots(slotCount);
+    uint32_t mask = (uint32_t)slotCount - 1;
+    for (int slotIndex = 0; slotIndex < vocabulary->slotCount; slotIndex++) {
+        if (vocabulary->slots[slotIndex].termId == -1) {
+            continue;
+        }
+        uint32_t newSlotIndex = vocabulary->slots[slotIndex].hash & mask;
+        while (slots[newSlotIndex].termId != -1) {
+            newSlotIndex = (newSlotIndex + 1) & mask;
+        }
+        slots[newSlotIndex] = vocabulary->slots[slotIndex];
+    }
+    free(vocabulary->slots);
+    vocabulary->slots = slots;
+    vocabulary->slotCount = slotCount;
+    vocabulary->maxWordCount = (int)(slotCount * VOCABULARY_MAX_LOAD_FACTOR);
+}
+
+/**
+ * Gets the term id of a word, assigning the next id to a word seen for the first time
+ * @param vocabulary Vocabulary to search
+ * @param word Word to look up, not necessarily null-terminated
+ * @param wordLength Length of the word
+ * @return Term id of the word
+ */
+int getTermId(Vocabulary *vocabulary, const char *word, int wordLength) {
+    uint32_t hash = hashFunction(word, wordLength);
+    uint32_t mask = (uint32_t)vocabulary->slotCount - 1;
+    uint32_t slotIndex = hash & mask;
+    while (vocabulary->slots[slotIndex].termId != -1) {
+        const VocabularySlot *slot = &vocabulary->slots[slotIndex];
+        if (slot->hash == hash && vocabulary->wordLengths[slot->termId] == wordLength && memcmp(vocabulary->words[slot->termId], word, wordLength) == 0) {
+            return slot->termId;
+        }
+        slotIndex = (slotIndex + 1) & mask;
+    }
+    // New word, grow the slot array first if it would become too full
+    if (vocabulary->wordCount >= vocabulary->maxWordCount) {
+        resizeVocabulary(vocabulary, vocabulary->slotCount * 2);
+        mask = (uint32_t)vocabulary->slotCount - 1;
+        slotIndex = hash & mask;
+        while (vocabulary->slots[slotIndex].termId != -1) {
+            slotIndex = (slotIndex + 1) & mask;
+        }
+    }
+    if (vocabulary->wordCount == vocabulary->wordCapacity) {
+        vocabulary->wordCapacity *= 2;
+        vocabulary->words = (char **)realloc(vocabulary->words, sizeof(char *) * vocabulary->wordCapacity);
+        vocabulary->wordLengths = (int *)realloc(vocabulary->wordLengths, sizeof(int) * vocabulary->wordCapacity);
+        if (vocabulary->words == NULL || vocabulary->wordLengths == NULL) {
+            printf("Error allocating memory!\n");
+            exit(1);
+        }
+    }
+    int termId = vocabulary->wordCount;
+    vocabulary->words[termId] = arenaCopyString(vocabulary->arena, word, wordLength);
+    vocabulary->wordLengths[termId] = wordLength;
+    vocabulary->slots[slotIndex].hash = hash;
+    vocabulary->slots[slotIndex].termId = termId;
+    vocabulary->wordCount++;
+    return termId;
+}
+
+int compareVocabularyTerms(const void *a, const void *b) {
+    return strcmp(((const VocabularyTerm *)a)->word, ((const VocabularyTerm *)b)->word);
+}
+
+/**
+ * Writes the words in sorted order with their term ids, one "<word> <term_id>" pair per line
+ * The line number of a word is its rank, IndexBuilder maps the term ids of the intermediate files to ranks with it
+ * Written once after all intermediate files, so term ids never have to be known in sorted order while parsing
+ * @param vocabulary Vocabulary to write
+ */
+void writeVocabularyToDisk(const Vocabulary *vocabulary) {
+    FILE *vocabularyFile = fopen("Vocabulary.txt", "w");
+    if (vocabularyFile == NULL) {
+        printf("Error opening file %s!\n", "Vocabulary.txt");
+        exit(1);
+    }
+    VocabularyTerm *terms = (VocabularyTerm *)malloc(sizeof(VocabularyTerm) * (vocabulary->wordCount + 1));
+    if (terms == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int termId = 0; termId < vocabulary->wordCount; termId++) {
+        terms[termId].word = vocabulary->words[termId];
+        terms[termId].termId = termId;
+    }
+    qsort(terms, vocabulary->wordCount, sizeof(VocabularyTerm), compareVocabularyTerms);
+    for (int rank = 0; rank < vocabulary->wordCount; rank++) {
+        fprintf(vocabularyFile, "%s %d\n", terms[rank].word, terms[rank].termId);
+    }
+    printf("File %s written with %d words in vocabulary.\n", "Vocabulary.txt", vocabulary->wordCount);
+    free(terms);
+    fclose(vocabularyFile);
+}
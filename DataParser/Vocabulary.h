@@ -0,0 +1,50 @@
+/* Vocabulary.h */
+#ifndef VOCABULARY_H
+#define VOCABULARY_H
+
+#include "MemoryArena.h"
+#include <stdint.h>
+
+/* Initial number of vocabulary slots, a power of two so that slot indices are taken with a mask */
+#define VOCABULARY_INITIAL_SLOT_COUNT (1 << 20)
+/* Maximum ratio of words to slots, the slot array doubles when an insertion would exceed it */
+#define VOCABULARY_MAX_LOAD_FACTOR 0.7
+
+/* Slot of the open addressing vocabulary, caches the hash of its word */
+typedef struct VocabularySlot {
+    uint32_t hash;  // Full hash of the word
+    int termId; // Term id of the word, -1 if the slot is empty
+} VocabularySlot;
+
+/* Word paired with its term id, sorted by word when the vocabulary is written */
+typedef struct VocabularyTerm {
+    const char *word;   // Word string, owned by the vocabulary
+    int termId; // Term id of the word
+} VocabularyTerm;
+
+/**
+ * Global vocabulary assigning dense term ids to words, shared by all intermediate files
+ * Ids are handed out in order of first write, the vocabulary file maps them to sorted order at the end
+ * Only the run writer thread assigns ids, so no locking is needed
+ */
+typedef struct Vocabulary {
+    int wordCount;  // Number of words, also the next term id
+    int wordCapacity;   // Capacity of the words and wordLengths arrays
+    int slotCount;  // Number of slots, always a power of two
+    int maxWordCount;   // Number of words allowed before the slot array has to grow
+    MemoryArena *arena; // Arena holding the words
+    char **words;   // Word of each term id
+    int *wordLengths;   // Length of the word of each term id
+    VocabularySlot *slots;  // Array of slots mapping words to term ids
+} Vocabulary;
+
+/* Function prototypes */
+Vocabulary *createVocabulary(); // Create a new empty vocabulary
+void freeVocabulary(Vocabulary *vocabulary);    // Free the vocabulary with all its words
+VocabularySlot *createVocabularySlots(int slotCount);   // Allocate an array of empty slots
+void resizeVocabulary(Vocabulary *vocabulary, int slotCount);   // Move all words into a slot array of a new size
+int getTermId(Vocabulary *vocabulary, const char *word, int wordLength);    // Get the term id of a word, assigning the next id to a new word
+int compareVocabularyTerms(const void *a, const void *b); // Compare two vocabulary terms by their words
+void writeVocabularyToDisk(const Vocabulary *vocabulary);   // Write the words in sorted order with their term ids
+
+#endif
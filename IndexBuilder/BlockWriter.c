@@ -0,0 +1,255 @@
+/* BlockWriter.c */
+#include "BlockWriter.h"
+#include "Compression.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Create the block pool and start the encoder and writer threads
+ * @param blockCount number of blocks in the pool
+ * @param encoderCount number of encoder threads
+ * @param codec codec the chunks are encoded with
+ * @param outputFilePrefix index files are named <prefix><file number>.bin
+ * @return pointer to the block writer
+ */
+BlockWriter *createBlockWriter(int blockCount, int encoderCount, IndexCodec codec, const char *outputFilePrefix) {
+    BlockWriter *writer = (BlockWriter *)malloc(sizeof(BlockWriter));
+    if (writer == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    writer->blockCount = blockCount;
+    writer->encoderCount = encoderCount;
+    writer->requests = (BlockWriteRequest *)malloc(sizeof(BlockWriteRequest) * blockCount);
+    writer->freeBlocks = (IndexBlock **)malloc(sizeof(IndexBlock *) * blockCount);
+    writer->encoderThreads = (pthread_t *)malloc(sizeof(pthread_t) * encoderCount);
+    if (writer->requests == NULL || writer->freeBlocks == NULL || writer->encoderThreads == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int i = 0; i < blockCount; i++) {
+        writer->requests[i].encodedBytes = (uint8_t *)malloc(MAX_ENCODED_BLOCK_SIZE);
+        if (writer->requests[i].encodedBytes == NULL) {
+            printf("Error allocating memory!\n");
+            exit(1);
+        }
+        writer->freeBlocks[i] = createIndexBlock();
+    }
+    writer->requestHead = 0;
+    writer->requestCount = 0;
+    writer->freeBlockCount = blockCount;
+    writer->codec = codec;
+    strncpy(writer->outputFilePrefix, outputFilePrefix, sizeof(writer->outputFilePrefix) - 1);
+    writer->outputFilePrefix[sizeof(writer->outputFilePrefix) - 1] = '\0';
+    writer->outputFile = NULL;
+    writer->outputFileNumber = -1;
+    writer->isShuttingDown = false;
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->requestReady, NULL);
+    pthread_cond_init(&writer->encodedReady, NULL);
+    pthread_cond_init(&writer->blockReady, NULL);
+    for (int i = 0; i < encoderCount; i++) {
+        if (pthread_create(&writer->encoderThreads[i], NULL, blockEncoderWorker, writer) != 0) {
+            printf("Error creating thread!\n");
+            exit(1);
+        }
+    }
+    if (pthread_create(&writer->writerThread, NULL, blockWriterWorker, writer) != 0) {
+        printf("Error creating thread!\n");
+        exit(1);
+    }
+    return writer;
+}
+
+/**
+ * Write all queued blocks, stop the threads and free the pool
+ * @param writer pointer to the block writer
+ */
+void freeBlockWriter(BlockWriter *writer) {
+    if (writer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&writer->mutex);
+    writer->isShuttingDown = true;
+    pthread_cond_broadcast(&writer->requestReady);
+    pthread_cond_broadcast(&writer->encodedReady);
+    pthread_mutex_unlock(&writer->mutex);
+    for (int i = 0; i < writer->encoderCount; i++) {
+        pthread_join(writer->encoderThreads[i], NULL);
+    }
+    pthread_join(writer->writerThread, NULL);
+    // Every block is back in the pool once the queue is drained, the block being filled last was submitted as well
+    for (int i = 0; i < writer->freeBlockCount; i++) {
+        free(writer->freeBlocks[i]);
+    }
+    for (int i = 0; i < writer->blockCount; i++) {
+        free(writer->requests[i].encodedBytes);
+    }
+    pthread_mutex_destroy(&writer->mutex);
+    pthread_cond_destroy(&writer->requestReady);
+    pthread_cond_destroy(&writer->encodedReady);
+    pthread_cond_destroy(&writer->blockReady);
+    free(writer->encoderThreads);
+    free(writer->requests);
+    free(writer->freeBlocks);
+    free(writer);
+}
+
+/**
+ * Take an empty block from the pool, waiting while all are being encoded or written
+ * @param writer pointer to the block writer
+ * @return pointer to an empty block
+ */
+IndexBlock *acquireIndexBlock(BlockWriter *writer) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->freeBlockCount == 0) {
+        pthread_cond_wait(&writer->blockReady, &writer->mutex);
+    }
+    writer->freeBlockCount--;
+    IndexBlock *block = writer->freeBlocks[writer->freeBlockCount];
+    pthread_mutex_unlock(&writer->mutex);
+    return block;
+}
+
+/**
+ * Queue a filled block to be encoded and written to an index file
+ * The queue holds at most one request per block, so it never overflows
+ * @param writer pointer to the block writer
+ * @param block block taken from the pool with acquireIndexBlock, not modified afterwards
+ * @param fileNumber index file the block belongs to, blocks of a file are submitted together
+ */
+void submitIndexBlock(BlockWriter *writer, IndexBlock *block, int fileNumber) {
+    pthread_mutex_lock(&writer->mutex);
+    BlockWriteRequest *request = &writer->requests[(writer->requestHead + writer->requestCount) % writer->blockCount];
+    request->block = block;
+    request->fileNumber = fileNumber;
+    request->isClaimed = false;
+    request->isEncoded = false;
+    request->encodedSize = 0;
+    writer->requestCount++;
+    pthread_cond_signal(&writer->requestReady);
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+/**
+ * Compress a block into its on-disk layout
+ * Format:
+ * 1. Chunk sizes array (int)
+ * 2. Last docIDs array (int)
+ * 3. Max impacts array (1 byte each, log compressed)
+ * 4. Each chunk encoded with the codec of the index, see encodeIndexChunk
+ * @param block block to compress
+ * @param codec codec the chunks are encoded with
+ * @param byteBuffer buffer of at least MAX_ENCODED_BLOCK_SIZE bytes
+ * @return number of bytes written to the buffer
+ */
+size_t encodeIndexBlock(const IndexBlock *block, IndexCodec codec, uint8_t *byteBuffer) {
+    size_t byteCount = 0;
+    // Write block metadata
+    memcpy(byteBuffer + byteCount, block->chunkSizes, sizeof(int) * MAX_CHUNK_COUNT);
+    byteCount += sizeof(int) * MAX_CHUNK_COUNT;
+    memcpy(byteBuffer + byteCount, block->lastDocIds, sizeof(int) * MAX_CHUNK_COUNT);
+    byteCount += sizeof(int) * MAX_CHUNK_COUNT;
+    memcpy(byteBuffer + byteCount, block->maxImpacts, sizeof(uint8_t) * MAX_CHUNK_COUNT);
+    byteCount += sizeof(uint8_t) * MAX_CHUNK_COUNT;
+    // Write each chunk's data, its size was recorded when the chunk was filled and block offsets depend on it
+    for (int chunkIndex = 0; chunkIndex < block->chunkCount; chunkIndex++) {
+        size_t chunkSize = encodeIndexChunk(&block->indexChunks[chunkIndex], codec, byteBuffer + byteCount);
+        if (chunkSize != (size_t)block->chunkSizes[chunkIndex]) {
+            printf("Error encoding chunk of size %d!\n", block->chunkSizes[chunkIndex]);
+            exit(1);
+        }
+        byteCount += chunkSize;
+    }
+    return byteCount;
+}
+
+/**
+ * Encoder thread compressing queued blocks
+ * Takes the oldest block no other encoder has taken, so blocks are encoded roughly in order and the writer rarely waits
+ * @param arg pointer to the block writer
+ * @return NULL
+ */
+void *blockEncoderWorker(void *arg) {
+    BlockWriter *writer = (BlockWriter *)arg;
+    pthread_mutex_lock(&writer->mutex);
+    while (true) {
+        BlockWriteRequest *request = NULL;
+        for (int i = 0; i < writer->requestCount; i++) {
+            BlockWriteRequest *queuedRequest = &writer->requests[(writer->requestHead + i) % writer->blockCount];
+            if (!queuedRequest->isClaimed) {
+                request = queuedRequest;
+                break;
+            }
+        }
+        if (request == NULL) {
+            if (writer->isShuttingDown) {
+                break;
+            }
+            pthread_cond_wait(&writer->requestReady, &writer->mutex);
+            continue;
+        }
+        request->isClaimed = true;
+        pthread_mutex_unlock(&writer->mutex);
+        // The request slot stays queued until it is written, so it is safe to fill without the lock
+        size_t encodedSize = encodeIndexBlock(request->block, writer->codec, request->encodedBytes);
+        pthread_mutex_lock(&writer->mutex);
+        request->encodedSize = encodedSize;
+        request->isEncoded = true;
+        pthread_cond_signal(&writer->encodedReady);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+    return NULL;
+}
+
+/**
+ * Writer thread appending encoded blocks to the index files in submission order
+ * Opens the next index file and writes its header when the first block of a file comes up, writing happens outside the lock
+ * @param arg pointer to the block writer
+ * @return NULL
+ */
+void *blockWriterWorker(void *arg) {
+    BlockWriter *writer = (BlockWriter *)arg;
+    pthread_mutex_lock(&writer->mutex);
+    while (true) {
+        while ((writer->requestCount == 0 && !writer->isShuttingDown) || (writer->requestCount > 0 && !writer->requests[writer->requestHead].isEncoded)) {
+            pthread_cond_wait(&writer->encodedReady, &writer->mutex);
+        }
+        if (writer->requestCount == 0) {
+            break;
+        }
+        BlockWriteRequest *request = &writer->requests[writer->requestHead];
+        pthread_mutex_unlock(&writer->mutex);
+        if (request->fileNumber != writer->outputFileNumber) {
+            if (writer->outputFile != NULL) {
+                fclose(writer->outputFile);
+            }
+            char outputFileName[48];
+            sprintf(outputFileName, "%s%d.bin", writer->outputFilePrefix, request->fileNumber);
+            writer->outputFile = fopen(outputFileName, "wb");
+            if (writer->outputFile == NULL) {
+                printf("Error opening file %s!\n", outputFileName);
+                exit(1);
+            }
+            // Record the codec so query processing picks the matching decoder
+            int fileHeader[2] = {INDEX_FILE_MAGIC, (int)writer->codec};
+            fwrite(fileHeader, sizeof(int), 2, writer->outputFile);
+            writer->outputFileNumber = request->fileNumber;
+        }
+        fwrite(request->encodedBytes, 1, request->encodedSize, writer->outputFile);
+        resetIndexBlock(request->block);
+        pthread_mutex_lock(&writer->mutex);
+        // Return the emptied block to the pool and free the request slot
+        writer->freeBlocks[writer->freeBlockCount] = request->block;
+        writer->freeBlockCount++;
+        writer->requestHead = (writer->requestHead + 1) % writer->blockCount;
+        writer->requestCount--;
+        pthread_cond_signal(&writer->blockReady);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+    if (writer->outputFile != NULL) {
+        fclose(writer->outputFile);
+        writer->outputFile = NULL;
+    }
+    return NULL;
+}
@@ -0,0 +1,61 @@
+/* BlockWriter.h */
+#ifndef BLOCK_WRITER_H
+#define BLOCK_WRITER_H
+
+#include "InvertedIndex.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Largest size (in bytes) of an encoded block, every posting taking a 5 byte docId and a 1 byte impact plus a chunk header of up to 2 bytes */
+#define MAX_ENCODED_BLOCK_SIZE (BLOCK_HEADER_SIZE + MAX_CHUNK_COUNT * (MAX_POSTING_COUNT * 6 + 2))
+
+/* Filled block waiting to be encoded and written */
+typedef struct BlockWriteRequest {
+    IndexBlock *block;  // Block holding the postings
+    int fileNumber; // Index file the block belongs to
+    bool isClaimed; // Set once an encoder thread has taken the block
+    bool isEncoded; // Set once the encoded bytes are ready to be written
+    uint8_t *encodedBytes;  // Buffer of MAX_ENCODED_BLOCK_SIZE bytes owned by the request slot
+    size_t encodedSize; // Number of encoded bytes
+} BlockWriteRequest;
+
+/**
+ * Background stage compressing and writing the blocks of an inverted index
+ * The merge takes empty blocks from the pool and hands them back filled, encoder threads compress them in any order
+ * and the writer thread appends them to the index files in submission order, then returns them to the pool
+ * The pool is bounded, so the merge only waits when every block is still being encoded or written
+ */
+typedef struct BlockWriter {
+    pthread_t *encoderThreads;  // Encoder threads
+    int encoderCount;   // Number of encoder threads
+    pthread_t writerThread; // Writer thread
+    pthread_mutex_t mutex;  // Protects the queue and the pool
+    pthread_cond_t requestReady;    // Signalled when a block is queued or the writer is shutting down
+    pthread_cond_t encodedReady;    // Signalled when a block is encoded or the writer is shutting down
+    pthread_cond_t blockReady;  // Signalled when a block returns to the pool
+    int blockCount; // Number of blocks in the pool, bounds the queue as well
+    BlockWriteRequest *requests;    // Circular queue of blocks to encode and write, in submission order
+    int requestHead;    // Index of the oldest queued request, the next one to write
+    int requestCount;   // Number of queued requests
+    IndexBlock **freeBlocks;    // Empty blocks ready to be filled
+    int freeBlockCount; // Number of empty blocks
+    IndexCodec codec;   // Codec the chunks are encoded with, recorded in the header of each index file
+    char outputFilePrefix[32];  // Index files are named <prefix><file number>.bin
+    FILE *outputFile;   // Index file currently written, only used by the writer thread
+    int outputFileNumber;   // Number of the index file currently written, -1 before the first block
+    bool isShuttingDown;    // Set once no more blocks will be queued
+} BlockWriter;
+
+/* Function prototypes */
+BlockWriter *createBlockWriter(int blockCount, int encoderCount, IndexCodec codec, const char *outputFilePrefix);  // Create a pool of blockCount blocks and start the encoder and writer threads
+void freeBlockWriter(BlockWriter *writer);  // Write all queued blocks, stop the threads and free the pool
+IndexBlock *acquireIndexBlock(BlockWriter *writer); // Take an empty block from the pool, waiting while all are being encoded or written
+void submitIndexBlock(BlockWriter *writer, IndexBlock *block, int fileNumber);  // Queue a filled block to be encoded and written to an index file
+size_t encodeIndexBlock(const IndexBlock *block, IndexCodec codec, uint8_t *byteBuffer);  // Compress a block into its on-disk layout
+void *blockEncoderWorker(void *arg);    // Encoder thread compressing queued blocks
+void *blockWriterWorker(void *arg); // Writer thread appending encoded blocks to the index files in order
+
+#endif
@@ -1,6 +1,7 @@
 /* Compression.c */
 #include "Compression.h"
 #include <math.h>
+#include <string.h>
 
 /**
  * Computes the number of bytes needed to encode a document ID using variable-byte encoding
@@ -83,3 +84,199 @@ uint8_t logCompressDouble(double impactScore) {
     uint8_t compressed = (uint8_t)(logImpactScore * 36.06); // Scale by 36.06 to maximize use of byte range
     return compressed;
 }
+
+/**
+ * Computes the number of bits needed to store a value
+ *
+ * @param value Value to be stored
+ * @return Number of significant bits, 0 for value 0
+ */
+int computeBitWidth(uint32_t value) {
+    int bitWidth = 0;
+    while (value > 0) {
+        value >>= 1;
+        bitWidth++;
+    }
+    return bitWidth;
+}
+
+/**
+ * Turns the docIds of a full chunk into the values bit packed by the packing codecs
+ * The first docId is stored on its own, so its slot holds 0, and every later slot holds its docId gap minus 1
+ *
+ * @param chunk Full chunk whose docIds hold the first docId followed by docId gaps
+ * @param values Array of MAX_POSTING_COUNT values to fill
+ */
+void computePackedGaps(const IndexChunk *chunk, uint32_t *values) {
+    values[0] = 0;
+    for (int postingIndex = 1; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
+        values[postingIndex] = (uint32_t)chunk->docIds[postingIndex] - 1;  // Gaps are at least 1
+    }
+}
+
+/**
+ * Chooses the bit width a full chunk is packed with
+ *
+ * Bit packing uses the width of the largest value. PForDelta tries every narrower width and keeps the one
+ * giving the smallest chunk, values that do not fit become exceptions costing a position byte and the VByte of their high bits.
+ *
+ * @param values Array of MAX_POSTING_COUNT values to pack
+ * @param codec BIT_PACKING_CODEC or PFOR_DELTA_CODEC
+ * @param exceptionCount Set to the number of values wider than the chosen width
+ * @return Chosen bit width, between 0 and 32
+ */
+int chooseBitWidth(const uint32_t *values, IndexCodec codec, int *exceptionCount) {
+    int widthCounts[33] = {0};
+    for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT; valueIndex++) {
+        widthCounts[computeBitWidth(values[valueIndex])]++;
+    }
+    int maxWidth = 32;
+    while (maxWidth > 0 && widthCounts[maxWidth] == 0) {
+        maxWidth--;
+    }
+    *exceptionCount = 0;
+    if (codec != PFOR_DELTA_CODEC) {
+        return maxWidth;
+    }
+    // Narrow the width while it pays off, keeping the wider width on ties as exceptions slow decoding down
+    int bestWidth = maxWidth;
+    long bestCost = (long)MAX_POSTING_COUNT / 8 * maxWidth;
+    for (int bitWidth = maxWidth - 1; bitWidth >= 0; bitWidth--) {
+        long cost = (long)MAX_POSTING_COUNT / 8 * bitWidth;
+        int widerCount = 0;
+        for (int width = bitWidth + 1; width <= maxWidth; width++) {
+            cost += (long)widthCounts[width] * (1 + (width - bitWidth + 6) / 7);
+            widerCount += widthCounts[width];
+        }
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestWidth = bitWidth;
+            *exceptionCount = widerCount;
+        }
+    }
+    return bestWidth;
+}
+
+/**
+ * Computes the size of a chunk once encoded, without encoding it
+ * Chunk sizes are needed while the index is built to record block offsets, long before the block is encoded
+ *
+ * @param chunk Chunk whose docIds hold the first docId followed by docId gaps
+ * @param codec Codec of the index
+ * @return Number of bytes encodeIndexChunk writes for the chunk
+ */
+size_t computeEncodedChunkSize(const IndexChunk *chunk, IndexCodec codec) {
+    // One impact byte per posting
+    size_t byteCount = chunk->postingCount;
+    if (codec == VBYTE_CODEC || chunk->postingCount < MAX_POSTING_COUNT) {
+        if (codec != VBYTE_CODEC) {
+            byteCount++;    // Partial chunk marker
+        }
+        for (int postingIndex = 0; postingIndex < chunk->postingCount; postingIndex++) {
+            byteCount += computeVarByteLength(chunk->docIds[postingIndex]);
+        }
+        return byteCount;
+    }
+    uint32_t values[MAX_POSTING_COUNT];
+    computePackedGaps(chunk, values);
+    int exceptionCount;
+    int bitWidth = chooseBitWidth(values, codec, &exceptionCount);
+    // Bit width, first docId and packed values
+    byteCount += 1 + computeVarByteLength(chunk->docIds[0]) + MAX_POSTING_COUNT / 8 * bitWidth;
+    if (codec == PFOR_DELTA_CODEC) {
+        // Exception count, then the position and high bits of each exception
+        byteCount++;
+        for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT; valueIndex++) {
+            if (computeBitWidth(values[valueIndex]) > bitWidth) {
+                byteCount += 1 + computeVarByteLength((int)(values[valueIndex] >> bitWidth));
+            }
+        }
+    }
+    return byteCount;
+}
+
+/**
+ * Bit packs MAX_POSTING_COUNT values into PACKING_LANE_COUNT interleaved 32-bit lanes
+ *
+ * Value i goes to lane i % PACKING_LANE_COUNT, and word k of every lane is stored next to each other,
+ * so a decoder loading one word of every lane at once gets consecutive values after shifting and masking.
+ * Only the low bitWidth bits of each value are kept.
+ *
+ * @param values Array of MAX_POSTING_COUNT values
+ * @param bitWidth Number of bits per value, between 0 and 32
+ * @param byteBuffer Buffer of at least MAX_POSTING_COUNT / 8 * bitWidth bytes
+ * @return Number of bytes written to buffer
+ */
+size_t bitPackInts(const uint32_t *values, int bitWidth, uint8_t *byteBuffer) {
+    uint32_t words[MAX_POSTING_COUNT] = {0};
+    uint32_t mask = bitWidth == 32 ? 0xFFFFFFFFu : (1u << bitWidth) - 1;
+    for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT && bitWidth > 0; valueIndex++) {
+        int lane = valueIndex % PACKING_LANE_COUNT;
+        int bitOffset = valueIndex / PACKING_LANE_COUNT * bitWidth;
+        int wordIndex = bitOffset / 32;
+        int shift = bitOffset % 32;
+        uint32_t value = values[valueIndex] & mask;
+        words[wordIndex * PACKING_LANE_COUNT + lane] |= value << shift;
+        // Spill the high bits into the next word of the lane
+        if (shift + bitWidth > 32) {
+            words[(wordIndex + 1) * PACKING_LANE_COUNT + lane] |= value >> (32 - shift);
+        }
+    }
+    size_t byteCount = MAX_POSTING_COUNT / 8 * bitWidth;
+    memcpy(byteBuffer, words, byteCount);
+    return byteCount;
+}
+
+/**
+ * Encodes the docIds and impact scores of a chunk
+ *
+ * Format of a full chunk with the packing codecs:
+ * 1. Bit width (1 byte)
+ * 2. Exception count (1 byte, PForDelta only)
+ * 3. VByte compressed first docID
+ * 4. Bit packed docID gaps minus 1, see bitPackInts
+ * 5. Position (1 byte) and VByte compressed high bits of each exception (PForDelta only)
+ * 6. Log compressed impact scores (1 byte each)
+ * Other chunks hold the VByte compressed first docID and docID gaps followed by the impact scores,
+ * preceded by PARTIAL_CHUNK_MARKER with the packing codecs.
+ *
+ * @param chunk Chunk whose docIds hold the first docId followed by docId gaps
+ * @param codec Codec of the index
+ * @param byteBuffer Buffer of at least MAX_POSTING_COUNT * 6 + 2 bytes
+ * @return Number of bytes written to buffer
+ */
+size_t encodeIndexChunk(const IndexChunk *chunk, IndexCodec codec, uint8_t *byteBuffer) {
+    size_t byteCount = 0;
+    if (codec == VBYTE_CODEC || chunk->postingCount < MAX_POSTING_COUNT) {
+        if (codec != VBYTE_CODEC) {
+            byteBuffer[byteCount++] = PARTIAL_CHUNK_MARKER;
+        }
+        // Write compressed docIDs
+        for (int postingIndex = 0; postingIndex < chunk->postingCount; postingIndex++) {
+            byteCount += varByteCompressInt(chunk->docIds[postingIndex], byteBuffer + byteCount);
+        }
+    } else {
+        uint32_t values[MAX_POSTING_COUNT];
+        computePackedGaps(chunk, values);
+        int exceptionCount;
+        int bitWidth = chooseBitWidth(values, codec, &exceptionCount);
+        byteBuffer[byteCount++] = (uint8_t)bitWidth;
+        if (codec == PFOR_DELTA_CODEC) {
+            byteBuffer[byteCount++] = (uint8_t)exceptionCount;
+        }
+        byteCount += varByteCompressInt(chunk->docIds[0], byteBuffer + byteCount);
+        byteCount += bitPackInts(values, bitWidth, byteBuffer + byteCount);
+        // Write the high bits of the values that did not fit
+        for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT && exceptionCount > 0; valueIndex++) {
+            if (computeBitWidth(values[valueIndex]) > bitWidth) {
+                byteBuffer[byteCount++] = (uint8_t)valueIndex;
+                byteCount += varByteCompressInt(values[valueIndex] >> bitWidth, byteBuffer + byteCount);
+            }
+        }
+    }
+    // Write compressed impact scores
+    for (int postingIndex = 0; postingIndex < chunk->postingCount; postingIndex++) {
+        byteBuffer[byteCount++] = logCompressDouble(chunk->impactScores[postingIndex]);
+    }
+    return byteCount;
+}
@@ -2,12 +2,22 @@
 #ifndef COMPRESSION_H
 #define COMPRESSION_H
 
+#include "InvertedIndex.h"
 #include <stdlib.h>
 #include <stdint.h>
 
+/* Number of interleaved 32-bit lanes of a bit packed chunk, one SSE register holds a word of every lane */
+#define PACKING_LANE_COUNT 4
+
 /* Function prototypes */
 int computeVarByteLength(int docId);    // Compute the number of bytes required to store docId using VByte encoding
 size_t varByteCompressInt(uint32_t docId, uint8_t *byteBuffer);    // Compress docId using VByte encoding
 uint8_t logCompressDouble(double impactScore);  // Compress impactScore using logarithmic encoding (1 byte)
+int computeBitWidth(uint32_t value);    // Compute the number of bits needed to store value
+void computePackedGaps(const IndexChunk *chunk, uint32_t *values);  // Turn the docIds of a full chunk into the values bit packed by the packing codecs
+int chooseBitWidth(const uint32_t *values, IndexCodec codec, int *exceptionCount);  // Choose the bit width of a full chunk, counting the values that do not fit
+size_t computeEncodedChunkSize(const IndexChunk *chunk, IndexCodec codec);  // Compute the size of a chunk once encoded, without encoding it
+size_t bitPackInts(const uint32_t *values, int bitWidth, uint8_t *byteBuffer);  // Bit pack MAX_POSTING_COUNT values into interleaved lanes
+size_t encodeIndexChunk(const IndexChunk *chunk, IndexCodec codec, uint8_t *byteBuffer);    // Encode the docIds and impact scores of a chunk
 
 #endif
@@ -2,10 +2,13 @@
 #include "IndexBuilder.h"
 #include "Compression.h"
 #include "Utils.h"
+#include "../DataParser/IntermediateRun.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
-#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 /**
  * Reads document length data from binary file
@@ -34,84 +37,67 @@ int *loadDocLengthsFromDisk() {
 }
 
 /**
- * Maps a portion of intermediate file content to memory
- * Uses memory mapping for efficient reading of large files
+ * Appends a new empty block to the end of the inverted index
+ * The previous tail block is full, it is handed to the block writer and its size, known from its chunk sizes, advances the tail block offset
  *
- * @param file File to read from
- * @param fileSize Total file size
- * @param offset Current file offset
- * @param remainingFileSize Remaining bytes in file
- * @param remainingBuffer Previous unprocessed content
- * @param remainingBufferSize Size of remaining buffer
- * @return Newly allocated buffer containing mapped data
- * @note Handles concatenation with previous unprocessed data
+ * @param invertedIndex Inverted index to append to
+ * @return Newly appended block
  */
-void *mapIntermediateContentFromDisk(FILE *file, const size_t fileSize, size_t *offset, size_t *remainingFileSize, void **remainingBuffer, size_t *remainingBufferSize) {
-    // Check if we've reached end of file
-    if (*offset >= fileSize) {
-        return NULL;
-    }
-    // Calculate size to map
-    *remainingFileSize = fileSize - *offset;
-    size_t mapSize = (*remainingFileSize < READ_SIZE) ? *remainingFileSize : READ_SIZE;
-    // Map file segment to memory
-    void *mappedContent = mmap(NULL, mapSize, PROT_READ, MAP_PRIVATE, fileno(file), (off_t)*offset);
-    if (mappedContent == MAP_FAILED) {
-        printf("Error mapping file!\n");
-        exit(1);
-    }
-    *offset += mapSize;
-    // Handle remaining buffer concatenation
-    void *newBuffer = NULL;
-    if (*remainingBuffer != NULL && *remainingBufferSize > 0) {
-        // Concatenate with existing buffer
-        newBuffer = malloc(mapSize + *remainingBufferSize);
-        memcpy(newBuffer, *remainingBuffer, *remainingBufferSize);
-        memcpy(newBuffer + *remainingBufferSize, mappedContent, mapSize);
-        *remainingBuffer = newBuffer;
-        *remainingBufferSize = mapSize + *remainingBufferSize;
+IndexBlock *appendIndexBlock(InvertedIndex *invertedIndex) {
+    IndexBlock *tailBlock = invertedIndex->tailIndexBlock;
+    if (tailBlock == NULL) {
+        // The first block of a file follows the file header
+        invertedIndex->tailBlockOffset = INDEX_FILE_HEADER_SIZE;
     } else {
-        // Create new buffer
-        newBuffer = malloc(mapSize);
-        memcpy(newBuffer, mappedContent, mapSize);
-        *remainingBuffer = newBuffer;
-        *remainingBufferSize = mapSize;
-    }
-    // Clean up mapped content
-    if (munmap(mappedContent, mapSize) == -1) {
-        printf("Error unmapping file!\n");
-        exit(1);
+        long tailBlockSize = BLOCK_HEADER_SIZE;
+        for (int chunkIndex = 0; chunkIndex < tailBlock->chunkCount; chunkIndex++) {
+            tailBlockSize += tailBlock->chunkSizes[chunkIndex];
+        }
+        submitIndexBlock(invertedIndex->blockWriter, tailBlock, invertedIndex->fileNumber);
+        invertedIndex->tailBlockOffset += tailBlockSize;
     }
-    return newBuffer;
+    IndexBlock *newBlock = acquireIndexBlock(invertedIndex->blockWriter);
+    invertedIndex->tailIndexBlock = newBlock;
+    invertedIndex->blockCount++;
+    return newBlock;
+}
+
+/**
+ * Completes the current index file by handing its tail block to the block writer
+ * The next block appended starts a new index file, chunk numbers carry on
+ *
+ * @param invertedIndex Inverted index whose file is complete
+ */
+void finishIndexFile(InvertedIndex *invertedIndex) {
+    if (invertedIndex->tailIndexBlock != NULL) {
+        submitIndexBlock(invertedIndex->blockWriter, invertedIndex->tailIndexBlock, invertedIndex->fileNumber);
+    }
+    invertedIndex->tailIndexBlock = NULL;
+    invertedIndex->tailBlockOffset = 0;
+    invertedIndex->blockCount = 0;
+    invertedIndex->fileNumber++;
 }
 
 /**
  * Adds parsed items to inverted index and lexicon
  * Handles block creation, chunk management, and impact score calculation
  *
- * @param parsedItems Array of parsed items of a word from different files
+ * @param parsedItems Array of parsed items of a word from different files, in file order
+ * @param itemCount Number of parsed items
  * @param invertedIndex Inverted index to add to
  * @param lexicon Lexicon to update
+ * @param vocabulary Sorted vocabulary holding the word of each term id
  * @param docLengths Array of document lengths for BM25 score calculation
  * @param totalDocCount Total number of documents for BM25 score calculation
  * @param avgDocLength Average document length for BM25 score calculation
  */
-void addParsedItemsToInvertedIndex(ParsedItem **parsedItems, InvertedIndex *invertedIndex, Lexicon *lexicon, const int *docLengths, int totalDocCount, int avgDocLength) {
+void addParsedItemsToInvertedIndex(const ParsedItem *parsedItems, int itemCount, InvertedIndex *invertedIndex, Lexicon *lexicon, const SortedVocabulary *vocabulary, const int *docLengths, int totalDocCount, int avgDocLength) {
     // Calculate term document count for BM25
-    int termDocCount = computeTermDocCount(parsedItems);
+    int termDocCount = computeTermDocCount(parsedItems, itemCount);
     // Retrieve or create current block
     IndexBlock *currentBlock = invertedIndex->tailIndexBlock;
     if (currentBlock == NULL || currentBlock->chunkCount == MAX_CHUNK_COUNT) {
-        IndexBlock *newBlock = createIndexBlock();
-        if (currentBlock == NULL) {
-            invertedIndex->headIndexBlock = newBlock;
-            invertedIndex->tailIndexBlock = newBlock;
-        } else {
-            currentBlock->nextIndexBlock = newBlock;
-            invertedIndex->tailIndexBlock = newBlock;
-        }
-        invertedIndex->blockCount++;
-        currentBlock = newBlock;
+        currentBlock = appendIndexBlock(invertedIndex);
     }
     // Initialize variables for tracking
     int chunkIndex = currentBlock->chunkCount;
@@ -119,28 +105,40 @@ void addParsedItemsToInvertedIndex(ParsedItem **parsedItems, InvertedIndex *inve
     currentBlock->chunkCount++;
     invertedIndex->chunkNumber++;
     int prevDocId = -1;
-    char *word = NULL;
     int startChunk = invertedIndex->chunkNumber;
+    // Record where the list starts so query processing can open it directly
+    long startBlockOffset = invertedIndex->tailBlockOffset;
+    int startChunkIndex = chunkIndex;
+    int maxImpact = 0;
     // Process each parsed item
-    for (int itemIndex = 0; itemIndex < MERGE_HEAP_SIZE; itemIndex++) {
-        if (parsedItems[itemIndex] == NULL) {
-            continue;
-        }
-        for (int postingIndex = 0; postingIndex < parsedItems[itemIndex]->postingCount; postingIndex++) {
-            word = parsedItems[itemIndex]->word;
-            int docId = parsedItems[itemIndex]->docIds[postingIndex];
-            int frequency = parsedItems[itemIndex]->frequencies[postingIndex];
+    const char *word = vocabulary->words[parsedItems[0].termId];
+    for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        // Decode docId gaps and frequencies in step, straight from the mapped intermediate file
+        const uint8_t *docIdCursor = parsedItems[itemIndex].docIdBytes;
+        const uint8_t *docIdEnd = docIdCursor + parsedItems[itemIndex].docIdByteLength;
+        const uint8_t *frequencyCursor = parsedItems[itemIndex].frequencyBytes;
+        const uint8_t *frequencyEnd = frequencyCursor + parsedItems[itemIndex].frequencyByteLength;
+        int docId = 0;
+        for (int postingIndex = 0; postingIndex < parsedItems[itemIndex].postingCount; postingIndex++) {
+            uint32_t docIdGap, frequency;
+            if (!decodeVarByte(&docIdCursor, docIdEnd, &docIdGap) || !decodeVarByte(&frequencyCursor, frequencyEnd, &frequency)) {
+                printf("Error decoding postings of word %s!\n", word);
+                exit(1);
+            }
+            docId += (int)docIdGap;
             // Calculate BM25 impact score
-            double impactScore = calculateBM25ImpactScore(totalDocCount, termDocCount, frequency, docLengths[docId - 1], avgDocLength);
-            // Move to next chunk if current chunk is full
+            double impactScore = calculateBM25ImpactScore(totalDocCount, termDocCount, (int)frequency, docLengths[docId - 1], avgDocLength);
+            // Track the largest impact as it will be stored, so the bound is exact after decompression
+            uint8_t compressedImpactScore = logCompressDouble(impactScore);
+            if (compressedImpactScore > maxImpact) {
+                maxImpact = compressedImpactScore;
+            }
+            // Move to next chunk if current chunk is full, its size is final once it is
             if (postingCount == MAX_POSTING_COUNT) {
+                currentBlock->chunkSizes[chunkIndex] = (int)computeEncodedChunkSize(&currentBlock->indexChunks[chunkIndex], invertedIndex->codec);
                 if (chunkIndex == MAX_CHUNK_COUNT - 1) {
                     // Create new block if needed
-                    IndexBlock *newBlock = createIndexBlock();
-                    currentBlock->nextIndexBlock = newBlock;
-                    invertedIndex->tailIndexBlock = newBlock;
-                    invertedIndex->blockCount++;
-                    currentBlock = newBlock;
+                    currentBlock = appendIndexBlock(invertedIndex);
                 }
                 chunkIndex = currentBlock->chunkCount;
                 postingCount = currentBlock->indexChunks[chunkIndex].postingCount;
@@ -151,70 +149,29 @@ void addParsedItemsToInvertedIndex(ParsedItem **parsedItems, InvertedIndex *inve
             // Store impact score and delta-encoded document ID, also update block metadata
             if (prevDocId != -1) {
                 currentBlock->indexChunks[chunkIndex].docIds[postingCount] = docId - prevDocId;
-                currentBlock->chunkSizes[chunkIndex] += computeVarByteLength(docId - prevDocId);
             } else {
                 currentBlock->indexChunks[chunkIndex].docIds[postingCount] = docId;
-                currentBlock->chunkSizes[chunkIndex] += computeVarByteLength(docId);
             }
             currentBlock->lastDocIds[chunkIndex] = docId;
             prevDocId = docId;
             currentBlock->indexChunks[chunkIndex].impactScores[postingCount] = impactScore;
-            currentBlock->chunkSizes[chunkIndex] += 1;
+            if (compressedImpactScore > currentBlock->maxImpacts[chunkIndex]) {
+                currentBlock->maxImpacts[chunkIndex] = compressedImpactScore;
+            }
             currentBlock->indexChunks[chunkIndex].postingCount++;
             postingCount = currentBlock->indexChunks[chunkIndex].postingCount;
         }
     }
+    // The last chunk of the word is complete as well
+    currentBlock->chunkSizes[chunkIndex] = (int)computeEncodedChunkSize(&currentBlock->indexChunks[chunkIndex], invertedIndex->codec);
     // Add a new node for the word to lexicon with chunk range
     int endChunk = invertedIndex->chunkNumber;
-    addNodeToLexicon(lexicon, word, startChunk, endChunk);
-}
-
-/**
- * Writes inverted index to binary file
- * Format: For each block:
- * 1. Chunk sizes array (int)
- * 2. Last docIDs array (int)
- * 3. For each chunk:
- *    - VByte compressed delta-encoded docIDs array (1-5 bytes each)
- *    - Log compressed impact scores array (1 byte each)
- *
- * @param invertedIndex Index to write
- * @param outputFileName Target file name
- */
-void writeInvertedIndexToDisk(const InvertedIndex *invertedIndex, const char *outputFileName) {
-    FILE *invertedIndexFile = fopen(outputFileName, "wb");
-    if (invertedIndexFile == NULL) {
-        printf("Error opening file %s!\n", outputFileName);
-        exit(1);
-    }
-    IndexBlock *currentBlock = invertedIndex->headIndexBlock;
-    while (currentBlock != NULL) {
-        // Write block metadata
-        fwrite(currentBlock->chunkSizes, sizeof(int), MAX_CHUNK_COUNT, invertedIndexFile);
-        fwrite(currentBlock->lastDocIds, sizeof(int), MAX_CHUNK_COUNT, invertedIndexFile);
-        // Write each chunk's data
-        for (int chunkIndex = 0; chunkIndex < currentBlock->chunkCount; chunkIndex++) {
-            // Write compressed docIDs
-            for (int postingIndex = 0; postingIndex < currentBlock->indexChunks[chunkIndex].postingCount; postingIndex++) {
-                uint8_t byteBuffer[5];
-                size_t byteCount = varByteCompressInt(currentBlock->indexChunks[chunkIndex].docIds[postingIndex], byteBuffer);
-                fwrite(byteBuffer, 1, byteCount, invertedIndexFile);
-            }
-            // Write compressed impact scores
-            for (int postingIndex = 0; postingIndex < currentBlock->indexChunks[chunkIndex].postingCount; postingIndex++) {
-                uint8_t compressedImpactScore = logCompressDouble(currentBlock->indexChunks[chunkIndex].impactScores[postingIndex]);
-                fwrite(&compressedImpactScore, 1, 1, invertedIndexFile);
-            }
-        }
-        currentBlock = currentBlock->nextIndexBlock;
-    }
-    printf("File %s written with %d blocks in inverted list.\n", outputFileName, invertedIndex->blockCount);
-    fclose(invertedIndexFile);
+    addNodeToLexicon(lexicon, word, startChunk, endChunk, termDocCount, invertedIndex->fileNumber, startBlockOffset, startChunkIndex, maxImpact);
 }
 
 /**
  * Writes lexicon to text file (ASCII format)
- * Format: <word> <start_chunk> <end_chunk>
+ * Format: <word> <start_chunk> <end_chunk> <doc_count> <file_number> <block_offset> <chunk_index> <max_impact>
  * One entry per line
  *
  * @param lexicon Lexicon to write
@@ -227,169 +184,452 @@ void writeLexiconToDisk(const Lexicon *lexicon) {
     }
     LexiconNode *currentNode = lexicon->headNode;
     while (currentNode != NULL) {
-        fprintf(lexiconFile, "%s %d %d\n", currentNode->word, currentNode->startChunk, currentNode->endChunk);
+        fprintf(lexiconFile, "%s %d %d %d %d %ld %d %d\n", currentNode->word, currentNode->startChunk, currentNode->endChunk, currentNode->docCount, currentNode->fileNumber, currentNode->blockOffset, currentNode->chunkIndex, currentNode->maxImpact);
         currentNode = currentNode->next;
     }
     printf("File %s written with %d words in lexicon.\n", "Lexicon.txt", lexicon->nodeCount);
     fclose(lexiconFile);
 }
 
+/**
+ * Counts the intermediate files written by DataParser, numbered from 0 without gaps
+ * @return Number of intermediate files
+ */
+int countIntermediateFiles() {
+    int fileCount = 0;
+    char fileName[32];
+    while (true) {
+        sprintf(fileName, "Intermediate%d.bin", fileCount);
+        if (access(fileName, F_OK) != 0) {
+            break;
+        }
+        fileCount++;
+    }
+    return fileCount;
+}
+
+/**
+ * Computes how many intermediate files may be merged at once
+ * Limited by MERGE_FAN_IN and by the open file limit of the process, keeping some descriptors for the index and lexicon files
+ * @return Maximum number of files merged at once, at least 2
+ */
+int getMergeFanIn() {
+    int fanIn = MERGE_FAN_IN;
+    struct rlimit fileLimit;
+    if (getrlimit(RLIMIT_NOFILE, &fileLimit) == 0 && fileLimit.rlim_cur != RLIM_INFINITY) {
+        long availableFileCount = (long)fileLimit.rlim_cur - RESERVED_FILE_DESCRIPTOR_COUNT;
+        if (availableFileCount < fanIn) {
+            fanIn = (int)availableFileCount;
+        }
+    }
+    return (fanIn < 2) ? 2 : fanIn;
+}
+
+/**
+ * Merges several intermediate files into a single one of the same format
+ * Used when there are more files than can be merged at once, the postings of a term are concatenated in file order
+ * @param inputFileNames Names of the files to merge, in ascending docId order
+ * @param inputCount Number of files to merge
+ * @param outputFileName Name of the merged file
+ * @param vocabulary Sorted vocabulary, maps ranks back to the term ids written to the file
+ */
+void mergeRunsToDisk(char **inputFileNames, int inputCount, const char *outputFileName, const SortedVocabulary *vocabulary) {
+    FILE *outputFile = fopen(outputFileName, "wb");
+    if (outputFile == NULL) {
+        printf("Error opening file %s!\n", outputFileName);
+        exit(1);
+    }
+    RunReader **readers = (RunReader **)malloc(sizeof(RunReader *) * inputCount);
+    ParsedItem *parsedItems = (ParsedItem *)malloc(sizeof(ParsedItem) * inputCount);
+    int *firstDocIds = (int *)malloc(sizeof(int) * inputCount);
+    int *lastDocIds = (int *)malloc(sizeof(int) * inputCount);
+    int *firstGapLengths = (int *)malloc(sizeof(int) * inputCount);
+    if (readers == NULL || parsedItems == NULL || firstDocIds == NULL || lastDocIds == NULL || firstGapLengths == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int inputIndex = 0; inputIndex < inputCount; inputIndex++) {
+        readers[inputIndex] = openRunReader(inputFileNames[inputIndex]);
+    }
+    MergeTree *tree = createMergeTree(readers, inputCount, vocabulary->termRanks);
+    uint8_t byteBuffer[4 * MAX_VARBYTE_LENGTH];
+    while (peekMergeTree(tree) != NULL) {
+        // Collect all items with same term
+        int itemCount = 0;
+        popMergeTree(tree, &parsedItems[itemCount++]);
+        while (peekMergeTree(tree) != NULL && peekMergeTree(tree)->termId == parsedItems[0].termId) {
+            popMergeTree(tree, &parsedItems[itemCount++]);
+        }
+        // Only the first gap of every item changes, it becomes relative to the last docId of the previous item
+        int postingCount = 0;
+        size_t docIdByteLength = 0;
+        size_t frequencyByteLength = 0;
+        for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+            const ParsedItem *parsedItem = &parsedItems[itemIndex];
+            const uint8_t *cursor = parsedItem->docIdBytes;
+            const uint8_t *end = cursor + parsedItem->docIdByteLength;
+            uint32_t docIdGap;
+            // Every item has at least one posting, its first gap is the first docId
+            decodeVarByte(&cursor, end, &docIdGap);
+            firstDocIds[itemIndex] = (int)docIdGap;
+            firstGapLengths[itemIndex] = (int)(cursor - parsedItem->docIdBytes);
+            int docId = (int)docIdGap;
+            while (decodeVarByte(&cursor, end, &docIdGap)) {
+                docId += (int)docIdGap;
+            }
+            lastDocIds[itemIndex] = docId;
+            int previousDocId = (itemIndex > 0) ? lastDocIds[itemIndex - 1] : 0;
+            postingCount += parsedItem->postingCount;
+            docIdByteLength += parsedItem->docIdByteLength - firstGapLengths[itemIndex] + computeVarByteSize((uint32_t)(firstDocIds[itemIndex] - previousDocId));
+            frequencyByteLength += parsedItem->frequencyByteLength;
+        }
+        // Write the original term id, posting count and byte lengths
+        size_t byteCount = encodeVarByte((uint32_t)vocabulary->termIds[parsedItems[0].termId], byteBuffer);
+        byteCount += encodeVarByte((uint32_t)postingCount, byteBuffer + byteCount);
+        byteCount += encodeVarByte((uint32_t)docIdByteLength, byteBuffer + byteCount);
+        byteCount += encodeVarByte((uint32_t)frequencyByteLength, byteBuffer + byteCount);
+        fwrite(byteBuffer, 1, byteCount, outputFile);
+        // Write the re-encoded first gap of every item followed by its remaining gaps as they are
+        for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+            const ParsedItem *parsedItem = &parsedItems[itemIndex];
+            int previousDocId = (itemIndex > 0) ? lastDocIds[itemIndex - 1] : 0;
+            byteCount = encodeVarByte((uint32_t)(firstDocIds[itemIndex] - previousDocId), byteBuffer);
+            fwrite(byteBuffer, 1, byteCount, outputFile);
+            fwrite(parsedItem->docIdBytes + firstGapLengths[itemIndex], 1, parsedItem->docIdByteLength - firstGapLengths[itemIndex], outputFile);
+        }
+        // Frequencies are not gap encoded, so they are copied as they are
+        for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+            fwrite(parsedItems[itemIndex].frequencyBytes, 1, parsedItems[itemIndex].frequencyByteLength, outputFile);
+        }
+    }
+    freeMergeTree(tree);
+    for (int inputIndex = 0; inputIndex < inputCount; inputIndex++) {
+        closeRunReader(readers[inputIndex]);
+    }
+    free(readers);
+    free(parsedItems);
+    free(firstDocIds);
+    free(lastDocIds);
+    free(firstGapLengths);
+    fclose(outputFile);
+}
+
+/**
+ * Compares two split samples by term id
+ * @param a Pointer to first split sample
+ * @param b Pointer to second split sample
+ * @return Negative if a < b, 0 if a == b, positive if a > b
+ */
+int compareSplitSamples(const void *a, const void *b) {
+    const SplitSample *sampleA = (const SplitSample *)a;
+    const SplitSample *sampleB = (const SplitSample *)b;
+    return (sampleA->termId > sampleB->termId) - (sampleA->termId < sampleB->termId);
+}
+
+/**
+ * Splits the sorted vocabulary into INDEX_SHARD_COUNT ranges holding about the same number of posting bytes
+ * Every SPLIT_SAMPLE_INTERVAL-th term of each intermediate file is sampled with the posting bytes read since the previous sample,
+ * the boundaries are placed where the sampled bytes, in term order, cross an equal share of the total
+ * @param runFileNames Intermediate files to sample
+ * @param runCount Number of intermediate files
+ * @param termRanks Rank in the sorted vocabulary of each term id written by DataParser
+ * @param wordCount Number of words in the sorted vocabulary
+ * @param splitTermIds Array of INDEX_SHARD_COUNT + 1 boundaries to fill, range k covers [splitTermIds[k], splitTermIds[k + 1])
+ */
+void computeShardSplitPoints(char **runFileNames, int runCount, const int *termRanks, int wordCount, int *splitTermIds) {
+    int sampleCapacity = 1024;
+    int sampleCount = 0;
+    SplitSample *samples = (SplitSample *)malloc(sizeof(SplitSample) * sampleCapacity);
+    if (samples == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    long totalWeight = 0;
+    for (int runIndex = 0; runIndex < runCount; runIndex++) {
+        // Only term headers are decoded, postings are skipped over
+        RunReader *reader = openRunReader(runFileNames[runIndex]);
+        ParsedItem parsedItem;
+        int itemCount = 0;
+        int lastTermId = -1;
+        long weight = 0;
+        while (readNextParsedItem(reader, termRanks, &parsedItem)) {
+            weight += parsedItem.docIdByteLength + parsedItem.frequencyByteLength;
+            lastTermId = parsedItem.termId;
+            itemCount++;
+            // The last term of the file closes the remainder
+            bool isSampled = itemCount % SPLIT_SAMPLE_INTERVAL == 0 || reader->cursor == reader->content + reader->contentSize;
+            if (!isSampled) {
+                continue;
+            }
+            if (sampleCount == sampleCapacity) {
+                sampleCapacity *= 2;
+                samples = (SplitSample *)realloc(samples, sizeof(SplitSample) * sampleCapacity);
+                if (samples == NULL) {
+                    printf("Error allocating memory!\n");
+                    exit(1);
+                }
+            }
+            samples[sampleCount].termId = lastTermId;
+            samples[sampleCount].weight = weight;
+            sampleCount++;
+            totalWeight += weight;
+            weight = 0;
+        }
+        closeRunReader(reader);
+    }
+    qsort(samples, sampleCount, sizeof(SplitSample), compareSplitSamples);
+    // Each boundary follows the sample where the running weight reaches its share
+    splitTermIds[0] = 0;
+    int sampleIndex = 0;
+    long runningWeight = 0;
+    for (int shardIndex = 1; shardIndex < INDEX_SHARD_COUNT; shardIndex++) {
+        long targetWeight = totalWeight * shardIndex / INDEX_SHARD_COUNT;
+        int splitTermId = splitTermIds[shardIndex - 1];
+        while (sampleIndex < sampleCount && runningWeight < targetWeight) {
+            runningWeight += samples[sampleIndex].weight;
+            splitTermId = samples[sampleIndex].termId + 1;
+            sampleIndex++;
+        }
+        // Keep the boundaries ordered, several samples may share a term id
+        if (splitTermId < splitTermIds[shardIndex - 1]) {
+            splitTermId = splitTermIds[shardIndex - 1];
+        }
+        splitTermIds[shardIndex] = splitTermId;
+    }
+    splitTermIds[INDEX_SHARD_COUNT] = wordCount;
+    free(samples);
+}
+
+/**
+ * Merges the vocabulary range of a shard into its own inverted index files and lexicon fragment
+ * The shard opens its own readers over the shared intermediate files, restricted to its range,
+ * and writes InvertedIndexShard<shard>_<file>.bin files that buildIndex renames once all shards are done
+ * @param arg Pointer to the IndexShard to merge
+ * @return NULL
+ */
+void *indexShardWorker(void *arg) {
+    IndexShard *shard = (IndexShard *)arg;
+    const int *termRanks = shard->vocabulary->termRanks;
+    // Open the files over the shard's range and build the tournament tree over them
+    RunReader **readers = (RunReader **)malloc(sizeof(RunReader *) * shard->runCount);
+    // Each file holds a term at most once, so a term has at most one item per file
+    ParsedItem *parsedItems = (ParsedItem *)malloc(sizeof(ParsedItem) * shard->runCount);
+    int fileBlockCapacity = 4;
+    shard->fileBlockCounts = (int *)malloc(sizeof(int) * fileBlockCapacity);
+    if (readers == NULL || parsedItems == NULL || shard->fileBlockCounts == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int runIndex = 0; runIndex < shard->runCount; runIndex++) {
+        readers[runIndex] = openRunReader(shard->runFileNames[runIndex]);
+        setRunReaderRange(readers[runIndex], termRanks, shard->startTermId, shard->endTermId);
+    }
+    MergeTree *tree = createMergeTree(readers, shard->runCount, termRanks);
+    // Initialize index structures, numbered from 0 within the shard
+    shard->lexicon = createLexicon();
+    shard->fileCount = 0;
+    char outputFilePrefix[32];
+    sprintf(outputFilePrefix, "InvertedIndexShard%d_", shard->shardNumber);
+    InvertedIndex *invertedIndex = createInvertedIndex();
+    invertedIndex->codec = shard->codec;
+    invertedIndex->blockWriter = createBlockWriter(SHARD_BLOCK_POOL_SIZE, BLOCK_ENCODER_THREAD_COUNT, shard->codec, outputFilePrefix);
+    // Main merge loop
+    while (peekMergeTree(tree) != NULL) {
+        // Collect all items with same term, they come out in file order
+        int itemCount = 0;
+        popMergeTree(tree, &parsedItems[itemCount++]);
+        while (peekMergeTree(tree) != NULL && peekMergeTree(tree)->termId == parsedItems[0].termId) {
+            popMergeTree(tree, &parsedItems[itemCount++]);
+        }
+        // Add collected items for the same word to index, full blocks are compressed and written in the background
+        addParsedItemsToInvertedIndex(parsedItems, itemCount, invertedIndex, shard->lexicon, shard->vocabulary, shard->docLengths, shard->totalDocCount, shard->avgDocLength);
+        // Start a new index file if its block count getting too large, and complete the last one at the end of the range
+        bool isLastTerm = peekMergeTree(tree) == NULL;
+        if (invertedIndex->blockCount >= MAX_BLOCK_COUNT || isLastTerm) {
+            if (shard->fileCount == fileBlockCapacity) {
+                fileBlockCapacity *= 2;
+                shard->fileBlockCounts = (int *)realloc(shard->fileBlockCounts, sizeof(int) * fileBlockCapacity);
+                if (shard->fileBlockCounts == NULL) {
+                    printf("Error allocating memory!\n");
+                    exit(1);
+                }
+            }
+            shard->fileBlockCounts[shard->fileCount] = invertedIndex->blockCount;
+            shard->fileCount++;
+            finishIndexFile(invertedIndex);
+        }
+    }
+    shard->chunkCount = invertedIndex->chunkNumber;
+    // Wait for the queued blocks to be written and clean up memory, the lexicon fragment is kept for buildIndex
+    freeBlockWriter(invertedIndex->blockWriter);
+    freeInvertedIndex(invertedIndex);
+    freeMergeTree(tree);
+    free(parsedItems);
+    for (int runIndex = 0; runIndex < shard->runCount; runIndex++) {
+        closeRunReader(readers[runIndex]);
+    }
+    free(readers);
+    return NULL;
+}
+
 /**
  * Main index building function
  * Merges intermediate files and builds final index structure
  * Process:
- * 1. Open all intermediate files
- * 2. Use min-heap for merging
- * 3. Build index incrementally
- * 4. Write results to disk
+ * 1. Find all intermediate files
+ * 2. Merge groups of files into larger ones while there are more than can be merged at once
+ * 3. Split the vocabulary into ranges and merge each range of the remaining files on its own thread with a tournament tree
+ * 4. Number the shard files globally and write the concatenated lexicon to disk
+ *
+ * @param codec Codec the chunks of the index are encoded with
  */
-void buildIndex() {
+void buildIndex(IndexCodec codec) {
     struct timeval start, end;
     gettimeofday(&start, NULL);
-    // Initialize file handling arrays
-    FILE *intermediateFiles[INTERMEDIATE_FILE_COUNT];
-    size_t fileSizes[INTERMEDIATE_FILE_COUNT];
-    size_t offsets[INTERMEDIATE_FILE_COUNT];
-    size_t remainingFileSizes[INTERMEDIATE_FILE_COUNT];
-    void *buffer[INTERMEDIATE_FILE_COUNT];
-    size_t remainingBufferSizes[INTERMEDIATE_FILE_COUNT];
-    void *remainingBuffer[INTERMEDIATE_FILE_COUNT];
-    // Create merge heap
-    MergeHeap *heap = createHeap();
-    // Open and initialize all intermediate files
-    for (int fileIndex = 0; fileIndex < INTERMEDIATE_FILE_COUNT; fileIndex++) {
-        // Open file
-        char *intermediateFileName = (char *)malloc(20);
-        sprintf(intermediateFileName, "Intermediate%d.bin", fileIndex);
-        intermediateFiles[fileIndex] = fopen(intermediateFileName, "r");
-        if (intermediateFiles[fileIndex] == NULL) {
-            printf("Error opening file %s!\n", intermediateFileName);
-            exit(1);
-        }
-        // Get file size
-        fseek(intermediateFiles[fileIndex], 0, SEEK_END);
-        fileSizes[fileIndex] = ftell(intermediateFiles[fileIndex]);
-        fseek(intermediateFiles[fileIndex], 0, SEEK_SET);
-        // Initialize buffer tracking variables
-        offsets[fileIndex] = 0;
-        remainingFileSizes[fileIndex] = fileSizes[fileIndex];
-        remainingBuffer[fileIndex] = NULL;
-        remainingBufferSizes[fileIndex] = 0;
-        // Map initial intermediate content
-        buffer[fileIndex] = mapIntermediateContentFromDisk(intermediateFiles[fileIndex], fileSizes[fileIndex], &offsets[fileIndex], &remainingFileSizes[fileIndex], &remainingBuffer[fileIndex], &remainingBufferSizes[fileIndex]);
-        // Add first parsed item to heap
-        ParsedItem *parsedItem = convertBinaryToParsedItem(&remainingBuffer[fileIndex], &remainingBufferSizes[fileIndex]);
-        if (parsedItem != NULL) {
-            MergeHeapNode heapNode;
-            heapNode.fileNumber = fileIndex;
-            heapNode.parsedItem = parsedItem;
-            insertHeapNode(heap, heapNode);
+    // Load the sorted vocabulary to remap term ids of intermediate files
+    SortedVocabulary *vocabulary = loadVocabularyFromDisk();
+    // Find all intermediate files, in ascending docId order
+    int runCount = countIntermediateFiles();
+    if (runCount == 0) {
+        printf("Error opening file %s!\n", "Intermediate0.bin");
+        exit(1);
+    }
+    char **runFileNames = (char **)malloc(sizeof(char *) * runCount);
+    bool *isTemporaryRun = (bool *)malloc(sizeof(bool) * runCount);
+    if (runFileNames == NULL || isTemporaryRun == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int runIndex = 0; runIndex < runCount; runIndex++) {
+        runFileNames[runIndex] = (char *)malloc(32);
+        sprintf(runFileNames[runIndex], "Intermediate%d.bin", runIndex);
+        isTemporaryRun[runIndex] = false;
+    }
+    // Merge consecutive groups of files while there are too many, keeping files in docId order
+    int fanIn = getMergeFanIn();
+    for (int passNumber = 0; runCount > fanIn; passNumber++) {
+        int mergedRunCount = 0;
+        for (int groupStart = 0; groupStart < runCount; groupStart += fanIn) {
+            int groupSize = (runCount - groupStart < fanIn) ? runCount - groupStart : fanIn;
+            char *mergedFileName = runFileNames[groupStart];
+            bool isTemporary = isTemporaryRun[groupStart];
+            if (groupSize > 1) {
+                mergedFileName = (char *)malloc(32);
+                sprintf(mergedFileName, "MergedRun%d_%d.bin", passNumber, mergedRunCount);
+                mergeRunsToDisk(&runFileNames[groupStart], groupSize, mergedFileName, vocabulary);
+                // Files written by earlier passes are no longer needed
+                for (int runIndex = groupStart; runIndex < groupStart + groupSize; runIndex++) {
+                    if (isTemporaryRun[runIndex]) {
+                        remove(runFileNames[runIndex]);
+                    }
+                    free(runFileNames[runIndex]);
+                }
+                isTemporary = true;
+            }
+            runFileNames[mergedRunCount] = mergedFileName;
+            isTemporaryRun[mergedRunCount] = isTemporary;
+            mergedRunCount++;
         }
+        printf("Merge pass %d reduced %d intermediate files to %d.\n", passNumber, runCount, mergedRunCount);
+        runCount = mergedRunCount;
     }
     // Load document statistics
     int *docLengths = loadDocLengthsFromDisk();
     int totalDocCount = DOC_COUNT;
     int avgDocLength = computeAvgDocLength(docLengths, totalDocCount);
-    // Initialize index structures
+    // Split the vocabulary into ranges of similar posting volume and merge them in parallel
+    int splitTermIds[INDEX_SHARD_COUNT + 1];
+    computeShardSplitPoints(runFileNames, runCount, vocabulary->termRanks, vocabulary->wordCount, splitTermIds);
+    IndexShard shards[INDEX_SHARD_COUNT];
+    pthread_t threads[INDEX_SHARD_COUNT];
+    for (int shardIndex = 0; shardIndex < INDEX_SHARD_COUNT; shardIndex++) {
+        shards[shardIndex].shardNumber = shardIndex;
+        shards[shardIndex].startTermId = splitTermIds[shardIndex];
+        shards[shardIndex].endTermId = splitTermIds[shardIndex + 1];
+        shards[shardIndex].runFileNames = runFileNames;
+        shards[shardIndex].runCount = runCount;
+        shards[shardIndex].vocabulary = vocabulary;
+        shards[shardIndex].docLengths = docLengths;
+        shards[shardIndex].totalDocCount = totalDocCount;
+        shards[shardIndex].avgDocLength = avgDocLength;
+        shards[shardIndex].codec = codec;
+        if (pthread_create(&threads[shardIndex], NULL, indexShardWorker, &shards[shardIndex]) != 0) {
+            printf("Error creating thread!\n");
+            exit(1);
+        }
+    }
+    for (int shardIndex = 0; shardIndex < INDEX_SHARD_COUNT; shardIndex++) {
+        pthread_join(threads[shardIndex], NULL);
+    }
+    // Number the shard files in vocabulary order and concatenate the lexicon fragments
     Lexicon *lexicon = createLexicon();
-    InvertedIndex *invertedIndex = createInvertedIndex();
     int fileNumber = 0;
-    // Initialize merge tracking variables
-    ParsedItem *parsedItems[MERGE_HEAP_SIZE];
-    ParsedItem *newParsedItem = NULL;
-    void* tempBuffer = NULL;
-    // Main merge loop
-    while (heap->nodeCount > 0) {
-        // Get minimum item
-        MergeHeapNode min = extractMin(heap);
-        parsedItems[min.fileNumber] = min.parsedItem;
-        // Try to get next item from same file
-        newParsedItem = convertBinaryToParsedItem(&remainingBuffer[min.fileNumber], &remainingBufferSizes[min.fileNumber]);
-        if (newParsedItem != NULL) {
-            // Add to heap if available
-            MergeHeapNode heapNode;
-            heapNode.fileNumber = min.fileNumber;
-            heapNode.parsedItem = newParsedItem;
-            insertHeapNode(heap, heapNode);
-        } else {
-            // Try to map more content
-            tempBuffer = mapIntermediateContentFromDisk(intermediateFiles[min.fileNumber], fileSizes[min.fileNumber], &offsets[min.fileNumber], &remainingFileSizes[min.fileNumber], &remainingBuffer[min.fileNumber], &remainingBufferSizes[min.fileNumber]);
-            free(buffer[min.fileNumber]);
-            buffer[min.fileNumber] = tempBuffer;
-            if (buffer[min.fileNumber] == NULL) {
-                continue;
-            }
-            newParsedItem = convertBinaryToParsedItem(&remainingBuffer[min.fileNumber], &remainingBufferSizes[min.fileNumber]);
-            if (newParsedItem != NULL) {
-                MergeHeapNode heapNode;
-                heapNode.fileNumber = min.fileNumber;
-                heapNode.parsedItem = newParsedItem;
-                insertHeapNode(heap, heapNode);
-            }
-        }
-        // Collect all items with same word
-        while(heap->nodeCount > 0 && strcmp(parsedItems[min.fileNumber]->word, heap->heapNodes[0].parsedItem->word) == 0) {
-            min = extractMin(heap);
-            parsedItems[min.fileNumber] = min.parsedItem;
-            // Similar process for getting next item from same file
-            newParsedItem = convertBinaryToParsedItem(&remainingBuffer[min.fileNumber], &remainingBufferSizes[min.fileNumber]);
-            if (newParsedItem != NULL) {
-                MergeHeapNode heapNode;
-                heapNode.fileNumber = min.fileNumber;
-                heapNode.parsedItem = newParsedItem;
-                insertHeapNode(heap, heapNode);
-            } else {
-                tempBuffer = mapIntermediateContentFromDisk(intermediateFiles[min.fileNumber], fileSizes[min.fileNumber], &offsets[min.fileNumber], &remainingFileSizes[min.fileNumber], &remainingBuffer[min.fileNumber], &remainingBufferSizes[min.fileNumber]);
-                free(buffer[min.fileNumber]);
-                buffer[min.fileNumber] = tempBuffer;
-                if (buffer[min.fileNumber] == NULL) {
-                    continue;
-                }
-                newParsedItem = convertBinaryToParsedItem(&remainingBuffer[min.fileNumber], &remainingBufferSizes[min.fileNumber]);
-                if (newParsedItem != NULL) {
-                    MergeHeapNode heapNode;
-                    heapNode.fileNumber = min.fileNumber;
-                    heapNode.parsedItem = newParsedItem;
-                    insertHeapNode(heap, heapNode);
-                }
+    int chunkNumber = 0;
+    for (int shardIndex = 0; shardIndex < INDEX_SHARD_COUNT; shardIndex++) {
+        for (int fileIndex = 0; fileIndex < shards[shardIndex].fileCount; fileIndex++) {
+            char shardFileName[48];
+            char outputFileName[32];
+            sprintf(shardFileName, "InvertedIndexShard%d_%d.bin", shardIndex, fileIndex);
+            sprintf(outputFileName, "InvertedIndex%d.bin", fileNumber + fileIndex);
+            if (rename(shardFileName, outputFileName) != 0) {
+                printf("Error renaming file %s!\n", shardFileName);
+                exit(1);
             }
+            printf("File %s written with %d blocks in inverted list.\n", outputFileName, shards[shardIndex].fileBlockCounts[fileIndex]);
         }
-        // Add collected items for the same word to index
-        addParsedItemsToInvertedIndex(parsedItems, invertedIndex, lexicon, docLengths, totalDocCount, avgDocLength);
-        freeParsedItems(parsedItems);
-        // Write out index if its block count getting too large and reset index
-        if (invertedIndex->blockCount >= MAX_BLOCK_COUNT) {
-            int slotNumber = invertedIndex->chunkNumber;
-            char *outputFileName = (char *)malloc(20);
-            sprintf(outputFileName, "InvertedIndex%d.bin", fileNumber);
-            fileNumber++;
-            writeInvertedIndexToDisk(invertedIndex, outputFileName);
-            freeInvertedIndex(invertedIndex);
-            invertedIndex = createInvertedIndex();
-            invertedIndex->chunkNumber = slotNumber;
-        }
+        appendLexicon(lexicon, shards[shardIndex].lexicon, fileNumber, chunkNumber);
+        fileNumber += shards[shardIndex].fileCount;
+        chunkNumber += shards[shardIndex].chunkCount;
+        free(shards[shardIndex].fileBlockCounts);
     }
-    // Write out the final index and clean up memory
-    char *outputFileName = (char *)malloc(20);
-    sprintf(outputFileName, "InvertedIndex%d.bin", fileNumber);
-    writeInvertedIndexToDisk(invertedIndex, outputFileName);
-    freeInvertedIndex(invertedIndex);
     // Write out the lexicon and clean up memory
     writeLexiconToDisk(lexicon);
     freeLexicon(lexicon);
-    freeHeap(heap);
-    // Close files and free buffers
-    for (int fileIndex = 0; fileIndex < INTERMEDIATE_FILE_COUNT; fileIndex++) {
-        fclose(intermediateFiles[fileIndex]);
-        free(buffer[fileIndex]);
+    // Remove the files written by merge passes
+    for (int runIndex = 0; runIndex < runCount; runIndex++) {
+        if (isTemporaryRun[runIndex]) {
+            remove(runFileNames[runIndex]);
+        }
+        free(runFileNames[runIndex]);
     }
+    free(runFileNames);
+    free(isTemporaryRun);
+    freeSortedVocabulary(vocabulary);
     free(docLengths);
     gettimeofday(&end, NULL);
     double elapsed_time = ((double)end.tv_sec - (double)start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
     printf("Index built in %.6f seconds.\n", elapsed_time);
 }
 
-int main() {
-    buildIndex();
+/**
+ * Parses the codec argument
+ * @param codecName Codec name, vbyte, bp or pfor
+ * @param codec Set to the parsed codec
+ * @return true if the name is a known codec
+ */
+bool parseIndexCodec(const char *codecName, IndexCodec *codec) {
+    if (strcmp(codecName, "vbyte") == 0) {
+        *codec = VBYTE_CODEC;
+    } else if (strcmp(codecName, "bp") == 0) {
+        *codec = BIT_PACKING_CODEC;
+    } else if (strcmp(codecName, "pfor") == 0) {
+        *codec = PFOR_DELTA_CODEC;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Builds the index with the default codec, or with the codec given as argument
+ * Usage: IndexBuilder [vbyte|bp|pfor]
+ */
+int main(int argc, char **argv) {
+    IndexCodec codec = DEFAULT_INDEX_CODEC;
+    if (argc > 2 || (argc == 2 && !parseIndexCodec(argv[1], &codec))) {
+        printf("Usage: %s [vbyte|bp|pfor]\n", argv[0]);
+        return 1;
+    }
+    buildIndex(codec);
     return 0;
 }
@@ -2,24 +2,74 @@
 #ifndef INDEX_BUILDER_H
 #define INDEX_BUILDER_H
 
-#include "MergeHeap.h"
+#include "BlockWriter.h"
+#include "MergeTree.h"
 #include "InvertedIndex.h"
 #include "Lexicon.h"
+#include "SortedVocabulary.h"
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 
-/* Number of intermediate files to merge, depends on the number of the intermediate files from the previous phase */
-#define INTERMEDIATE_FILE_COUNT 8
-/* Buffer size for reading intermediate file from disk (48MB) */
-#define READ_SIZE (48 * 1024 * 1024)
+/* Maximum number of intermediate files merged at once, more files are first merged in several passes */
+#define MERGE_FAN_IN 64
+/* File descriptors kept free for the index, lexicon and standard streams when the fan-in is limited by the open file limit */
+#define RESERVED_FILE_DESCRIPTOR_COUNT 16
+/* Number of vocabulary ranges merged in parallel, each written to its own inverted index files */
+#define INDEX_SHARD_COUNT 4
+/* Number of blocks of an index shard, the one being filled and the ones waiting to be compressed or written */
+#define SHARD_BLOCK_POOL_SIZE 8
+/* Number of threads compressing the blocks of an index shard */
+#define BLOCK_ENCODER_THREAD_COUNT 2
+/* Number of terms of an intermediate file between two samples used to place the shard boundaries */
+#define SPLIT_SAMPLE_INTERVAL 64
+/* Codec the index is built with when none is given on the command line */
+#define DEFAULT_INDEX_CODEC PFOR_DELTA_CODEC
 /* Total number of documents in the collection.tsv dataset, hardcoded */
 #define DOC_COUNT 8841822
 
+/**
+ * Term sampled from an intermediate file to balance the vocabulary ranges of the shards
+ */
+typedef struct SplitSample {
+    int termId; // Rank of the sampled term in the sorted vocabulary
+    long weight;    // Posting bytes of the file from the previous sample up to this term
+} SplitSample;
+
+/**
+ * Vocabulary range merged by one thread into its own inverted index files and lexicon fragment
+ * File and chunk numbers in the fragment start from 0, they are shifted once all shards are done
+ */
+typedef struct IndexShard {
+    int shardNumber;    // Position of the shard, used in its temporary file names
+    int startTermId;    // First term id of the range
+    int endTermId;  // Term id right after the range (exclusive)
+    char **runFileNames;    // Intermediate files to merge, shared by all shards
+    int runCount;   // Number of intermediate files
+    const SortedVocabulary *vocabulary; // Sorted vocabulary, shared by all shards
+    const int *docLengths;  // Document lengths for BM25, shared by all shards
+    int totalDocCount;  // Total number of documents for BM25
+    int avgDocLength;   // Average document length for BM25
+    IndexCodec codec;   // Codec the chunks are encoded with
+    Lexicon *lexicon;   // Lexicon fragment built by the shard
+    int fileCount;  // Number of inverted index files written by the shard
+    int chunkCount; // Number of chunks written by the shard
+    int *fileBlockCounts;   // Number of blocks in each file written by the shard
+} IndexShard;
+
 /* Function prototypes */
 int *loadDocLengthsFromDisk();  // Load document lengths from disk
-void *mapIntermediateContentFromDisk(FILE *file, const size_t fileSize, size_t *offset, size_t *remainingFileSize, void **remainingBuffer, size_t *remainingBufferSize);    // Map intermediate file content from disk
-void addParsedItemsToInvertedIndex(ParsedItem **parsedItems, InvertedIndex *invertedIndex, Lexicon *lexicon, const int *docLengths, int totalDocCount, int avgDocLength);   // Add parsed items of a word to inverted index, update lexicon
-void writeInvertedIndexToDisk(const InvertedIndex *invertedIndex, const char *outputFileName);  // Write inverted index to disk
+IndexBlock *appendIndexBlock(InvertedIndex *invertedIndex);  // Append a new block to the inverted index, handing the full tail block to the block writer
+void finishIndexFile(InvertedIndex *invertedIndex); // Hand the tail block to the block writer, the next block starts a new index file
+void addParsedItemsToInvertedIndex(const ParsedItem *parsedItems, int itemCount, InvertedIndex *invertedIndex, Lexicon *lexicon, const SortedVocabulary *vocabulary, const int *docLengths, int totalDocCount, int avgDocLength);   // Add parsed items of a word to inverted index, update lexicon
 void writeLexiconToDisk(const Lexicon *lexicon);    // Write lexicon to disk
-void buildIndex();  // Build inverted index from intermediate files, compress and write to disk
+int countIntermediateFiles();   // Count the intermediate files written by the previous phase
+int getMergeFanIn();    // Compute how many intermediate files may be merged at once
+void mergeRunsToDisk(char **inputFileNames, int inputCount, const char *outputFileName, const SortedVocabulary *vocabulary); // Merge several intermediate files into a single one of the same format
+int compareSplitSamples(const void *a, const void *b);  // Compare split samples by term id for qsort
+void computeShardSplitPoints(char **runFileNames, int runCount, const int *termRanks, int wordCount, int *splitTermIds);    // Split the vocabulary into ranges holding about the same number of posting bytes
+void *indexShardWorker(void *arg);  // Merge the vocabulary range of a shard into its own inverted index files and lexicon fragment
+void buildIndex(IndexCodec codec);  // Build inverted index from intermediate files, compress with the codec and write to disk
+bool parseIndexCodec(const char *codecName, IndexCodec *codec); // Parse the codec argument
 
 #endif
@@ -13,6 +13,7 @@
  * Memory layout:
  * - Array of chunk sizes for compressed data
  * - Array of last document IDs for query processing
+ * - Array of maximum compressed impact scores for dynamic pruning
  * - Array of chunks, each containing:
  *   * Document IDs
  *   * Impact scores
@@ -33,28 +34,39 @@ IndexBlock *createIndexBlock() {
         printf("Error allocating memory!\n");
         exit(1);
     }
-    // Initialize all chunks and metadata
-    newBlock->chunkCount = 0;
-     for (int chunkIndex = 0; chunkIndex < MAX_CHUNK_COUNT; chunkIndex++) {
-         // Initialize block metadata for chunk
-         newBlock->chunkSizes[chunkIndex] = 0;
-         newBlock->lastDocIds[chunkIndex] = -1;
-         // Initialize postings in chunk
-         for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
-             newBlock->indexChunks[chunkIndex].postingCount = 0;
-             newBlock->indexChunks[chunkIndex].docIds[postingIndex] = -1;
-             newBlock->indexChunks[chunkIndex].impactScores[postingIndex] = 0.0;
-         }
-     }
-    newBlock->nextIndexBlock = NULL;
+    resetIndexBlock(newBlock);
     return newBlock;
 }
 
+/**
+ * Empties an index block so it can be filled again
+ * Blocks are recycled by the block writer once written, so a reset block must look exactly like a new one
+ *
+ * @param indexBlock Index block to reset
+ */
+void resetIndexBlock(IndexBlock *indexBlock) {
+    // Initialize all chunks and metadata
+    indexBlock->chunkCount = 0;
+    for (int chunkIndex = 0; chunkIndex < MAX_CHUNK_COUNT; chunkIndex++) {
+        // Initialize block metadata for chunk
+        indexBlock->chunkSizes[chunkIndex] = 0;
+        indexBlock->lastDocIds[chunkIndex] = -1;
+        indexBlock->maxImpacts[chunkIndex] = 0;
+        // Initialize postings in chunk
+        indexBlock->indexChunks[chunkIndex].postingCount = 0;
+        for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
+            indexBlock->indexChunks[chunkIndex].docIds[postingIndex] = -1;
+            indexBlock->indexChunks[chunkIndex].impactScores[postingIndex] = 0.0;
+        }
+    }
+}
+
 /**
  * Creates and initializes a new inverted index
  *
  * The inverted index is the main data structure for storing term-document relationships.
- * It maintains a linked list of blocks, where each block contains multiple chunks of postings.
+ * It fills one block at a time, where each block contains multiple chunks of postings,
+ * and hands every full block to the block writer that compresses and writes it.
  * This structure allows for:
  * - Efficient storage of variable-length posting lists
  * - Quick query processing capabilities
@@ -68,7 +80,7 @@ IndexBlock *createIndexBlock() {
  *     ├── Chunk 2
  *     └── ... (64 chunks max)
  * └── Block 2
- * └── ... (24000 blocks max)
+ * └── ... (24000 blocks max per file)
  */
 InvertedIndex *createInvertedIndex() {
     InvertedIndex *newIndex = (InvertedIndex *)malloc(sizeof(InvertedIndex));
@@ -79,50 +91,22 @@ InvertedIndex *createInvertedIndex() {
     // Initialize index metadata
     newIndex->chunkNumber = 0;
     newIndex->blockCount = 0;
-    newIndex->headIndexBlock = NULL;
+    newIndex->fileNumber = 0;
+    newIndex->tailBlockOffset = 0;
     newIndex->tailIndexBlock = NULL;
+    newIndex->blockWriter = NULL;
+    newIndex->codec = VBYTE_CODEC;
     return newIndex;
 }
 
 /**
- * Frees all memory associated with an inverted index
+ * Frees the inverted index structure
  *
- * Systematically releases memory by:
- * 1. Resetting all counters and metadata
- * 2. Traversing the block linked list
- * 3. Cleaning each block's chunks and postings
- * 4. Freeing block structures
- * 5. Finally freeing the index structure
+ * Blocks are owned by the block writer's pool, including a tail block that was never handed back,
+ * so only the index structure itself is released here.
  *
  * @param invertedIndex Pointer to inverted index to be freed
- *
- * Note: This function ensures complete cleanup without memory leaks
- * by methodically resetting and freeing all nested structures.
  */
 void freeInvertedIndex(InvertedIndex *invertedIndex) {
-    invertedIndex->chunkNumber = 0;
-    invertedIndex->blockCount = 0;
-    // Traverse and free blocks
-    IndexBlock *currentBlock = invertedIndex->headIndexBlock;
-    while (currentBlock != NULL) {
-        IndexBlock *nextBlock = currentBlock->nextIndexBlock;
-        // Reset and clean block data
-        currentBlock->chunkCount = 0;
-        for (int chunkIndex = 0; chunkIndex < MAX_CHUNK_COUNT; chunkIndex++) {
-            // Reset block metadata for chunk
-            currentBlock->chunkSizes[chunkIndex] = 0;
-            currentBlock->lastDocIds[chunkIndex] = 0;
-            // Reset postings in chunk
-            for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
-                currentBlock->indexChunks[chunkIndex].postingCount = 0;
-                currentBlock->indexChunks[chunkIndex].docIds[postingIndex] = 0;
-                currentBlock->indexChunks[chunkIndex].impactScores[postingIndex] = 0.0;
-            }
-        }
-        // Free block structure
-        free(currentBlock);
-        currentBlock = nextBlock;
-    }
-    // Free index structure
     free(invertedIndex);
 }
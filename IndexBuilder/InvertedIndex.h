@@ -2,12 +2,33 @@
 #ifndef INVERTED_INDEX_H
 #define INVERTED_INDEX_H
 
+#include <stdint.h>
+
 /* Maximum postings per chunk */
 #define MAX_POSTING_COUNT 128
 /* Maximum chunks per block */
 #define MAX_CHUNK_COUNT 64
-/* Maximum blocks per index */
+/* Maximum blocks per index file */
 #define MAX_BLOCK_COUNT 24000
+/* Size (in bytes) of the metadata written in front of each block, i.e., chunk sizes, last document IDs and max impacts */
+#define BLOCK_HEADER_SIZE (2 * MAX_CHUNK_COUNT * sizeof(int) + MAX_CHUNK_COUNT * sizeof(uint8_t))
+/* Magic number written at the start of each index file */
+#define INDEX_FILE_MAGIC 0x58444e49
+/* Size (in bytes) of the header written at the start of each index file, i.e., magic number and codec */
+#define INDEX_FILE_HEADER_SIZE (2 * sizeof(int))
+/* First byte of a chunk holding fewer than MAX_POSTING_COUNT postings in a bit packing or PForDelta index, such chunks stay in VByte */
+#define PARTIAL_CHUNK_MARKER 0xFF
+
+/**
+ * Encodings of the docIds of a chunk, recorded in the header of each index file
+ * Impact scores are always stored as one log compressed byte per posting after the docIds
+ */
+typedef enum IndexCodec {
+    VBYTE_CODEC,        // VByte compressed first docId and docId gaps
+    BIT_PACKING_CODEC,  // Full chunks store docId gaps bit packed with a single width, in four interleaved 32-bit lanes
+    PFOR_DELTA_CODEC,   // Full chunks store docId gaps bit packed with a narrower width, larger gaps are patched from exceptions
+    INDEX_CODEC_COUNT   // Number of codecs
+} IndexCodec;
 
 /**
  * Represents a chunk of postings in the inverted index
@@ -23,30 +44,34 @@ typedef struct IndexChunk {
 /**
  * Represents a block in the inverted index
  * A block contains multiple chunks and maintains metadata about them
- * Blocks are linked together to handle large posting lists
+ * Blocks are filled one after the other and handed to the block writer once full
  */
 typedef struct IndexBlock {
     int chunkCount; // Current number of chunks in the block
     int chunkSizes[MAX_CHUNK_COUNT];    // Size (in bytes) of each chunk after compression (for jumping)
     int lastDocIds[MAX_CHUNK_COUNT];    // Last document ID in each chunk (for query processing)
+    uint8_t maxImpacts[MAX_CHUNK_COUNT];    // Maximum log compressed impact score in each chunk (for dynamic pruning)
     IndexChunk indexChunks[MAX_CHUNK_COUNT];    // Array of chunks
-    struct IndexBlock *nextIndexBlock;  // Pointer to the next block in the index
 } IndexBlock;
 
 /**
  * Represents the main inverted index structure
- * Maintains a linked list of blocks and tracks global statistics
+ * Only holds the block being filled and tracks global statistics, earlier blocks are already with the block writer
  */
 typedef struct InvertedIndex {
     int chunkNumber;    // Current number of chunks in the index, used for recording chunk allocation in lexicon
     int blockCount; // Current number of blocks in the index
-    IndexBlock *headIndexBlock; // Pointer to the first block in the index
-    IndexBlock *tailIndexBlock; // Pointer to the last block in the index
+    int fileNumber; // Number of the index file this index will be written to, recorded in lexicon
+    long tailBlockOffset;   // Byte offset of the last block in its index file, recorded in lexicon
+    IndexBlock *tailIndexBlock; // Pointer to the block being filled, NULL before the first block of a file
+    struct BlockWriter *blockWriter;    // Block writer the blocks are taken from and handed back to
+    IndexCodec codec;   // Codec the chunks are encoded with, needed to know their sizes
 } InvertedIndex;
 
 /* Function prototypes */
 IndexBlock *createIndexBlock(); // Create new index block
+void resetIndexBlock(IndexBlock *indexBlock);   // Empty an index block so it can be filled again
 InvertedIndex *createInvertedIndex();   // Create new inverted index
-void freeInvertedIndex(InvertedIndex *invertedIndex);   // Free memory allocated for inverted index
+void freeInvertedIndex(InvertedIndex *invertedIndex);   // Free memory allocated for inverted index, its blocks belong to the block writer
 
 #endif
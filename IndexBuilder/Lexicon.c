@@ -28,7 +28,6 @@ void freeLexicon(Lexicon *lexicon) {
     LexiconNode *currentNode = lexicon->headNode;
     while (currentNode != NULL) {
         LexiconNode *nextNode = currentNode->next;
-        free(currentNode->word);
         currentNode->startChunk = 0;
         currentNode->endChunk = 0;
         free(currentNode);
@@ -40,18 +39,26 @@ void freeLexicon(Lexicon *lexicon) {
 /**
  * Adds a new node (word) to the lexicon
  * @param lexicon Pointer to the lexicon structure to add the node
- * @param word Word string to be added
+ * @param word Word string to be added, not copied, so it must outlive the lexicon
  * @param startChunk Start chunk number in the inverted index for the word
  * @param endChunk End chunk number in the inverted index for the word
+ * @param docCount Number of documents containing the word
+ * @param fileNumber Number of the inverted index file containing the word
+ * @param blockOffset Byte offset in the index file of the block containing the start chunk
+ * @param chunkIndex Index of the start chunk within that block
+ * @param maxImpact Maximum log compressed impact score among the word's postings
  */
-void addNodeToLexicon(Lexicon *lexicon, const char *word, int startChunk, int endChunk) {
+void addNodeToLexicon(Lexicon *lexicon, const char *word, int startChunk, int endChunk, int docCount, int fileNumber, long blockOffset, int chunkIndex, int maxImpact) {
     // Create and initialize new node
     LexiconNode *newNode = (LexiconNode *)malloc(sizeof(LexiconNode));
-    char *newWord = (char *)malloc(strlen(word) + 1);
-    strcpy(newWord, word);
-    newNode->word = newWord;
+    newNode->word = word;
     newNode->startChunk = startChunk;
     newNode->endChunk = endChunk;
+    newNode->docCount = docCount;
+    newNode->fileNumber = fileNumber;
+    newNode->blockOffset = blockOffset;
+    newNode->chunkIndex = chunkIndex;
+    newNode->maxImpact = maxImpact;
     newNode->next = NULL;
     // Add to empty lexicon or append to the end of the list
     if (lexicon->headNode == NULL) {
@@ -63,3 +70,29 @@ void addNodeToLexicon(Lexicon *lexicon, const char *word, int startChunk, int en
     }
     lexicon->nodeCount++;
 }
+
+/**
+ * Moves all nodes of a lexicon fragment to the end of a lexicon and frees the fragment
+ * The fragment was built with its own file and chunk numbers starting from 0, they are shifted to follow the ones already in the lexicon
+ * @param lexicon Lexicon to append to
+ * @param fragment Lexicon fragment to move, freed afterwards
+ * @param fileNumberOffset Number of index files before the fragment's first file
+ * @param chunkNumberOffset Number of chunks before the fragment's first chunk
+ */
+void appendLexicon(Lexicon *lexicon, Lexicon *fragment, int fileNumberOffset, int chunkNumberOffset) {
+    for (LexiconNode *currentNode = fragment->headNode; currentNode != NULL; currentNode = currentNode->next) {
+        currentNode->fileNumber += fileNumberOffset;
+        currentNode->startChunk += chunkNumberOffset;
+        currentNode->endChunk += chunkNumberOffset;
+    }
+    if (fragment->headNode != NULL) {
+        if (lexicon->headNode == NULL) {
+            lexicon->headNode = fragment->headNode;
+        } else {
+            lexicon->tailNode->next = fragment->headNode;
+        }
+        lexicon->tailNode = fragment->tailNode;
+        lexicon->nodeCount += fragment->nodeCount;
+    }
+    free(fragment);
+}
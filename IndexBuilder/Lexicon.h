@@ -4,9 +4,14 @@
 
 /* Node structure for lexicon entries, stores word and its location information in the inverted index */
 typedef struct LexiconNode {
-    char *word; // Word string in the lexicon
+    const char *word;   // Word string in the lexicon, owned by the sorted vocabulary
     int startChunk; // Start chunk number in the inverted index
     int endChunk;   // End chunk number in the inverted index
+    int docCount;   // Number of documents containing the word, i.e., document frequency
+    int fileNumber; // Number of the inverted index file containing the word
+    long blockOffset;   // Byte offset in the index file of the block containing the start chunk
+    int chunkIndex; // Index of the start chunk within that block
+    int maxImpact;  // Maximum log compressed impact score among the word's postings, upper bound for dynamic pruning
     struct LexiconNode *next; // Pointer to the next node in the linked list
 } LexiconNode;
 
@@ -20,6 +25,7 @@ typedef struct Lexicon {
 /* Function declarations */
 Lexicon *createLexicon();   // Create a new lexicon
 void freeLexicon(Lexicon *lexicon); // Free memory allocated for the lexicon
-void addNodeToLexicon(Lexicon *lexicon, const char *word, int startChunk, int endChunk);    // Add a new node (word) to the lexicon
+void appendLexicon(Lexicon *lexicon, Lexicon *fragment, int fileNumberOffset, int chunkNumberOffset);   // Move all nodes of a lexicon fragment to the end of a lexicon, shifting their locations
+void addNodeToLexicon(Lexicon *lexicon, const char *word, int startChunk, int endChunk, int docCount, int fileNumber, long blockOffset, int chunkIndex, int maxImpact);   // Add a new node (word) to the lexicon
 
 #endif
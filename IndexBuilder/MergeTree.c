@@ -0,0 +1,266 @@
+/* MergeTree.c */
+#include "MergeTree.h"
+#include "../DataParser/IntermediateRun.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Decodes the header of the next term of an intermediate file into a parsed item, see IntermediateRun.h for the format
+ * Only the term id, posting count and byte lengths are decoded, the item points at the postings without copying them
+ * @param cursor Pointer to the current position in the file, advanced past the term on success
+ * @param end End of the mapped file (exclusive)
+ * @param termRanks Rank in the sorted vocabulary of each term id written by DataParser
+ * @param parsedItem Parsed item to fill
+ * @return true if a complete term was decoded, false at the end of the file
+ */
+bool convertBinaryToParsedItem(const uint8_t **cursor, const uint8_t *end, const int *termRanks, ParsedItem *parsedItem) {
+    const uint8_t *position = *cursor;
+    uint32_t termId, postingCount, docIdByteLength, frequencyByteLength;
+    if (!decodeVarByte(&position, end, &termId) || !decodeVarByte(&position, end, &postingCount)
+        || !decodeVarByte(&position, end, &docIdByteLength) || !decodeVarByte(&position, end, &frequencyByteLength)) {
+        return false;
+    }
+    if ((size_t)(end - position) < (size_t)docIdByteLength + frequencyByteLength) {
+        printf("Error reading intermediate file, term %u is cut off!\n", termId);
+        return false;
+    }
+    // Remap the term id to its rank and point at the postings
+    parsedItem->termId = termRanks[termId];
+    parsedItem->postingCount = (int)postingCount;
+    parsedItem->docIdBytes = position;
+    parsedItem->docIdByteLength = docIdByteLength;
+    parsedItem->frequencyBytes = position + docIdByteLength;
+    parsedItem->frequencyByteLength = frequencyByteLength;
+    *cursor = position + docIdByteLength + frequencyByteLength;
+    return true;
+}
+
+/**
+ * Maps an intermediate file for sequential reading
+ * The whole file stays mapped, so parsed items can point into it and nothing is copied on refill
+ * @param fileName Name of the intermediate file
+ * @return Newly created reader positioned at the first term
+ */
+RunReader *openRunReader(const char *fileName) {
+    RunReader *reader = (RunReader *)malloc(sizeof(RunReader));
+    if (reader == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    int fileDescriptor = open(fileName, O_RDONLY);
+    if (fileDescriptor == -1) {
+        printf("Error opening file %s!\n", fileName);
+        exit(1);
+    }
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) == -1) {
+        printf("Error opening file %s!\n", fileName);
+        exit(1);
+    }
+    reader->contentSize = (size_t)fileStat.st_size;
+    reader->content = NULL;
+    if (reader->contentSize > 0) {
+        void *mappedContent = mmap(NULL, reader->contentSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mappedContent == MAP_FAILED) {
+            printf("Error mapping file!\n");
+            exit(1);
+        }
+        // Items are consumed once from front to back
+        madvise(mappedContent, reader->contentSize, MADV_SEQUENTIAL);
+        reader->content = (const uint8_t *)mappedContent;
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fileDescriptor);
+    reader->cursor = reader->content;
+    reader->endTermId = INT_MAX;
+    return reader;
+}
+
+/**
+ * Unmaps an intermediate file, parsed items read from it must no longer be used
+ * @param reader Reader to close
+ */
+void closeRunReader(RunReader *reader) {
+    if (reader == NULL) {
+        return;
+    }
+    if (reader->content != NULL && munmap((void *)reader->content, reader->contentSize) == -1) {
+        printf("Error unmapping file!\n");
+        exit(1);
+    }
+    free(reader);
+}
+
+/**
+ * Restricts a reader to a range of term ids, skipping the terms before it
+ * Skipping only decodes term headers, the byte lengths jump over the postings
+ * @param reader Reader positioned before the range, usually freshly opened
+ * @param termRanks Rank in the sorted vocabulary of each term id written by DataParser
+ * @param startTermId First term id of the range
+ * @param endTermId Term id right after the range (exclusive)
+ */
+void setRunReaderRange(RunReader *reader, const int *termRanks, int startTermId, int endTermId) {
+    reader->endTermId = endTermId;
+    if (reader->content == NULL) {
+        return;
+    }
+    const uint8_t *end = reader->content + reader->contentSize;
+    ParsedItem parsedItem;
+    const uint8_t *itemStart = reader->cursor;
+    while (convertBinaryToParsedItem(&reader->cursor, end, termRanks, &parsedItem)) {
+        if (parsedItem.termId >= startTermId) {
+            // Leave the first term of the range to be read again
+            reader->cursor = itemStart;
+            return;
+        }
+        itemStart = reader->cursor;
+    }
+}
+
+/**
+ * Reads the next parsed item of an intermediate file
+ * @param reader Reader of the intermediate file
+ * @param termRanks Rank in the sorted vocabulary of each term id written by DataParser
+ * @param parsedItem Parsed item to fill, valid until the reader is closed
+ * @return true if an item was read, false at the end of the file or of the reader's range
+ */
+bool readNextParsedItem(RunReader *reader, const int *termRanks, ParsedItem *parsedItem) {
+    if (reader->content == NULL) {
+        return false;
+    }
+    const uint8_t *itemStart = reader->cursor;
+    if (!convertBinaryToParsedItem(&reader->cursor, reader->content + reader->contentSize, termRanks, parsedItem)) {
+        return false;
+    }
+    if (parsedItem->termId >= reader->endTermId) {
+        reader->cursor = itemStart;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Creates a merge tree over the first item of every source
+ * @param readers Reader of each source, sources must be given in ascending docId order
+ * @param sourceCount Number of sources, at least 1
+ * @param termRanks Rank in the sorted vocabulary of each term id written by DataParser
+ * @return Newly created merge tree
+ */
+MergeTree *createMergeTree(RunReader **readers, int sourceCount, const int *termRanks) {
+    MergeTree *tree = (MergeTree *)malloc(sizeof(MergeTree));
+    if (tree == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    tree->sourceCount = sourceCount;
+    tree->readers = readers;
+    tree->termRanks = termRanks;
+    tree->items = (ParsedItem *)malloc(sizeof(ParsedItem) * sourceCount);
+    tree->losers = (int *)malloc(sizeof(int) * sourceCount);
+    if (tree->items == NULL || tree->losers == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    for (int source = 0; source < sourceCount; source++) {
+        if (!readNextParsedItem(readers[source], termRanks, &tree->items[source])) {
+            tree->items[source].termId = EXHAUSTED_TERM_ID;
+        }
+    }
+    // Internal nodes are 1 to sourceCount - 1, leaves are sourceCount to 2 * sourceCount - 1
+    tree->losers[0] = buildMergeTreeNode(tree, 1);
+    return tree;
+}
+
+/**
+ * Frees the merge tree, the readers stay open
+ * @param tree Merge tree to free
+ */
+void freeMergeTree(MergeTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+    free(tree->items);
+    free(tree->losers);
+    free(tree);
+}
+
+/**
+ * Checks whether a source wins against another one
+ * Smaller term id wins, ties go to the earlier source so postings stay in ascending docId order, exhausted sources always lose
+ * @param tree Merge tree
+ * @param source First source
+ * @param otherSource Second source
+ * @return true if the first source wins
+ */
+bool isMergeWinner(const MergeTree *tree, int source, int otherSource) {
+    int termId = tree->items[source].termId;
+    int otherTermId = tree->items[otherSource].termId;
+    if (termId == EXHAUSTED_TERM_ID || otherTermId == EXHAUSTED_TERM_ID) {
+        return otherTermId == EXHAUSTED_TERM_ID && (termId != EXHAUSTED_TERM_ID || source < otherSource);
+    }
+    if (termId != otherTermId) {
+        return termId < otherTermId;
+    }
+    return source < otherSource;
+}
+
+/**
+ * Plays all matches below a node, storing the loser of each one
+ * @param tree Merge tree
+ * @param node Node to play, leaves are numbered from sourceCount
+ * @return Source winning at the node
+ */
+int buildMergeTreeNode(MergeTree *tree, int node) {
+    if (node >= tree->sourceCount) {
+        return node - tree->sourceCount;
+    }
+    int left = buildMergeTreeNode(tree, 2 * node);
+    int right = buildMergeTreeNode(tree, 2 * node + 1);
+    if (isMergeWinner(tree, left, right)) {
+        tree->losers[node] = right;
+        return left;
+    }
+    tree->losers[node] = left;
+    return right;
+}
+
+/**
+ * Gets the smallest item without taking it
+ * @param tree Merge tree
+ * @return Smallest item, NULL once all sources are exhausted
+ */
+const ParsedItem *peekMergeTree(const MergeTree *tree) {
+    const ParsedItem *parsedItem = &tree->items[tree->losers[0]];
+    return (parsedItem->termId == EXHAUSTED_TERM_ID) ? NULL : parsedItem;
+}
+
+/**
+ * Takes the smallest item and advances its source, then replays the path from its leaf to the root
+ * @param tree Merge tree
+ * @param parsedItem Parsed item to fill with the smallest item
+ * @return true if an item was taken, false once all sources are exhausted
+ */
+bool popMergeTree(MergeTree *tree, ParsedItem *parsedItem) {
+    int winner = tree->losers[0];
+    if (tree->items[winner].termId == EXHAUSTED_TERM_ID) {
+        return false;
+    }
+    *parsedItem = tree->items[winner];
+    if (!readNextParsedItem(tree->readers[winner], tree->termRanks, &tree->items[winner])) {
+        tree->items[winner].termId = EXHAUSTED_TERM_ID;
+    }
+    // The new item only has to play against the losers on its path
+    for (int node = (winner + tree->sourceCount) / 2; node > 0; node /= 2) {
+        if (isMergeWinner(tree, tree->losers[node], winner)) {
+            int loser = winner;
+            winner = tree->losers[node];
+            tree->losers[node] = loser;
+        }
+    }
+    tree->losers[0] = winner;
+    return true;
+}
@@ -0,0 +1,60 @@
+/* MergeTree.h */
+#ifndef MERGE_TREE_H
+#define MERGE_TREE_H
+
+#include <stdbool.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Term id of the current item of an exhausted source */
+#define EXHAUSTED_TERM_ID (-1)
+
+/**
+ * Structure for parsed items from binary intermediate files, contains a term and all postings' information
+ * The postings are not copied, the item points at their compressed bytes in the mapped intermediate file
+ */
+typedef struct ParsedItem {
+    int termId; // Term id remapped to the rank of the word in the sorted vocabulary, so ids compare in alphabetical order
+    int postingCount;   // Number of postings, i.e., number of documents containing the word
+    const uint8_t *docIdBytes;  // VByte docId gaps in ascending docId order, the first one relative to 0
+    size_t docIdByteLength; // Number of bytes of the docId gaps
+    const uint8_t *frequencyBytes;  // VByte frequencies of the word in the corresponding documents
+    size_t frequencyByteLength; // Number of bytes of the frequencies
+} ParsedItem;
+
+/* Sequential reader of one intermediate file, mapped as a whole for as long as its parsed items are in use */
+typedef struct RunReader {
+    const uint8_t *content; // Read-only mapping of the whole file, NULL for an empty file
+    size_t contentSize; // Size of the file
+    const uint8_t *cursor;  // Start of the next item to decode
+    int endTermId;  // Items from this term id on are not read, so a reader can cover a range of the vocabulary
+} RunReader;
+
+/**
+ * Tournament tree of losers merging sorted intermediate files
+ * Every internal node keeps the source that lost the match played there, the overall winner is kept in node 0,
+ * so replacing the winner replays a single leaf to root path with one comparison per level
+ */
+typedef struct MergeTree {
+    int sourceCount;    // Number of merged sources, i.e., leaves of the tree
+    RunReader **readers;    // Reader of each source, not owned by the tree
+    const int *termRanks;   // Rank in the sorted vocabulary of each term id written by DataParser
+    ParsedItem *items;  // Current item of each source, EXHAUSTED_TERM_ID once the source has no more items
+    int *losers;    // Losing source of each internal node, losers[0] holds the winner
+} MergeTree;
+
+/* Function prototypes */
+bool convertBinaryToParsedItem(const uint8_t **cursor, const uint8_t *end, const int *termRanks, ParsedItem *parsedItem); // Decode the header of the next term of an intermediate file into a parsed item
+RunReader *openRunReader(const char *fileName); // Map an intermediate file for sequential reading
+void closeRunReader(RunReader *reader); // Unmap an intermediate file
+void setRunReaderRange(RunReader *reader, const int *termRanks, int startTermId, int endTermId);  // Restrict a reader to a range of term ids, skipping the terms before it
+bool readNextParsedItem(RunReader *reader, const int *termRanks, ParsedItem *parsedItem);   // Read the next parsed item, false at the end of the file or its range
+MergeTree *createMergeTree(RunReader **readers, int sourceCount, const int *termRanks);  // Create a merge tree over the first item of every source
+void freeMergeTree(MergeTree *tree);    // Free the merge tree
+bool isMergeWinner(const MergeTree *tree, int source, int otherSource);  // Check whether a source wins against another one
+int buildMergeTreeNode(MergeTree *tree, int node);  // Play all matches below a node, return the winning source
+const ParsedItem *peekMergeTree(const MergeTree *tree); // Get the smallest item without taking it, NULL once all sources are exhausted
+bool popMergeTree(MergeTree *tree, ParsedItem *parsedItem); // Take the smallest item and advance its source, false once all sources are exhausted
+
+#endif
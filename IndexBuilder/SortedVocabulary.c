@@ -0,0 +1,79 @@
+/* SortedVocabulary.c */
+#include "SortedVocabulary.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Loads the sorted vocabulary and builds the term id remapping
+ * Format: <word> <term_id>, one line per word in alphabetical order
+ *
+ * @return Loaded vocabulary, caller must free
+ * @note Exits on file/memory errors
+ */
+SortedVocabulary *loadVocabularyFromDisk() {
+    FILE *vocabularyFile = fopen("Vocabulary.txt", "r");
+    if (vocabularyFile == NULL) {
+        printf("Error opening file %s!\n", "Vocabulary.txt");
+        exit(1);
+    }
+    SortedVocabulary *vocabulary = (SortedVocabulary *)malloc(sizeof(SortedVocabulary));
+    if (vocabulary == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    // Count lines first so both arrays are allocated once
+    int wordCount = 0;
+    int character;
+    while ((character = fgetc(vocabularyFile)) != EOF) {
+        if (character == '\n') {
+            wordCount++;
+        }
+    }
+    fseek(vocabularyFile, 0, SEEK_SET);
+    vocabulary->wordCount = wordCount;
+    vocabulary->words = (char **)malloc(sizeof(char *) * (wordCount + 1));
+    vocabulary->termRanks = (int *)malloc(sizeof(int) * (wordCount + 1));
+    vocabulary->termIds = (int *)malloc(sizeof(int) * (wordCount + 1));
+    if (vocabulary->words == NULL || vocabulary->termRanks == NULL || vocabulary->termIds == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    // Read words in rank order, the term id follows the last space
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLength;
+    int rank = 0;
+    while (rank < wordCount && (lineLength = getline(&line, &lineCapacity, vocabularyFile)) != -1) {
+        char *separator = strrchr(line, ' ');
+        int termId = (separator != NULL) ? atoi(separator + 1) : -1;
+        if (termId < 0 || termId >= wordCount) {
+            printf("Error reading file %s!\n", "Vocabulary.txt");
+            exit(1);
+        }
+        vocabulary->words[rank] = strndup(line, separator - line);
+        vocabulary->termRanks[termId] = rank;
+        vocabulary->termIds[rank] = termId;
+        rank++;
+    }
+    free(line);
+    fclose(vocabularyFile);
+    return vocabulary;
+}
+
+/**
+ * Frees the vocabulary with all its words
+ * @param vocabulary Vocabulary to free
+ */
+void freeSortedVocabulary(SortedVocabulary *vocabulary) {
+    if (vocabulary == NULL) {
+        return;
+    }
+    for (int rank = 0; rank < vocabulary->wordCount; rank++) {
+        free(vocabulary->words[rank]);
+    }
+    free(vocabulary->words);
+    free(vocabulary->termRanks);
+    free(vocabulary->termIds);
+    free(vocabulary);
+}
@@ -0,0 +1,21 @@
+/* SortedVocabulary.h */
+#ifndef SORTED_VOCABULARY_H
+#define SORTED_VOCABULARY_H
+
+/**
+ * Global vocabulary written by DataParser, words in sorted order with their term ids
+ * Intermediate files carry term ids in order of first write, they are remapped to the rank of their word,
+ * so the merge compares integers and still produces words in alphabetical order
+ */
+typedef struct SortedVocabulary {
+    int wordCount;  // Number of words in the vocabulary
+    char **words;   // Word of each rank, in alphabetical order
+    int *termRanks; // Rank of the word of each term id
+    int *termIds;   // Term id of the word of each rank, used to write merged intermediate files
+} SortedVocabulary;
+
+/* Function prototypes */
+SortedVocabulary *loadVocabularyFromDisk();   // Load the sorted vocabulary and build the term id remapping
+void freeSortedVocabulary(SortedVocabulary *vocabulary);    // Free the vocabulary with all its words
+
+#endif
@@ -32,21 +32,20 @@ int computeAvgDocLength(const int *docLengths, int totalDocCount) {
  * intermediate files. The count is used in BM25's IDF calculation.
  *
  * @param parsedItems Array of parsed items from different files
+ * @param itemCount Number of parsed items
  * @return Total number of documents containing the term
  *
  * Example:
  * If a term appears in:
  * - 5 documents in file 1
  * - 3 documents in file 2
- * - NULL in file 3
+ * - no documents in file 3
  * The function returns 8
  */
-int computeTermDocCount(ParsedItem **parsedItems) {
+int computeTermDocCount(const ParsedItem *parsedItems, int itemCount) {
     int termDocCount = 0;
-    for (int itemIndex = 0; itemIndex < MERGE_HEAP_SIZE; itemIndex++) {
-        if (parsedItems[itemIndex] != NULL) {
-            termDocCount += parsedItems[itemIndex]->postingCount;
-        }
+    for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+        termDocCount += parsedItems[itemIndex].postingCount;
     }
     return termDocCount;
 }
@@ -0,0 +1,167 @@
+/* BatchProcessor.c */
+#include "BatchProcessor.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Loads all queries from a query file
+ * File format: <queryId>\t<queryText>\n, lines without a tab are skipped
+ * @param queryFileName Name of the query file
+ * @param queryCount Pointer to store the number of queries loaded
+ * @return Array of queries or NULL on error
+ */
+BatchQuery *loadBatchQueries(const char *queryFileName, int *queryCount) {
+    FILE *queryFile = fopen(queryFileName, "r");
+    if (queryFile == NULL) {
+        printf("Error opening file %s!\n", queryFileName);
+        return NULL;
+    }
+    int capacity = 1024;
+    BatchQuery *queries = (BatchQuery *)malloc(capacity * sizeof(BatchQuery));
+    *queryCount = 0;
+    char *line = NULL;
+    size_t len = 0;
+    while (getline(&line, &len, queryFile) != -1) {
+        char *tab = strchr(line, '\t');
+        if (tab == NULL) {
+            continue;
+        }
+        *tab = '\0';    // Split at tab
+        char *queryText = tab + 1;
+        // Remove trailing newline
+        queryText[strcspn(queryText, "\r\n")] = 0;
+        // Grow query array if needed
+        if (*queryCount == capacity) {
+            capacity *= 2;
+            queries = (BatchQuery *)realloc(queries, capacity * sizeof(BatchQuery));
+        }
+        queries[*queryCount].queryId = strdup(line);
+        queries[*queryCount].queryText = strdup(queryText);
+        (*queryCount)++;
+    }
+    free(line);
+    fclose(queryFile);
+    return queries;
+}
+
+/**
+ * Frees memory allocated for loaded queries
+ * @param queries Array of queries
+ * @param queryCount Number of queries in the array
+ */
+void freeBatchQueries(BatchQuery *queries, int queryCount) {
+    for (int queryIndex = 0; queryIndex < queryCount; queryIndex++) {
+        free(queries[queryIndex].queryId);
+        free(queries[queryIndex].queryText);
+    }
+    free(queries);
+}
+
+/**
+ * Writes the results of a query in TREC run format
+ * Format: <queryId> Q0 <docId> <rank> <score> <runTag>, ranks starting from 1
+ * @param runFile Run file to write to
+ * @param queryId Query identifier
+ * @param heap Sorted query results
+ */
+void writeTrecRun(FILE *runFile, const char *queryId, const QueryHeap *heap) {
+    for (int i = 0; i < heap->nodeCount; i++) {
+        fprintf(runFile, "%s Q0 %d %d %.6f %s\n", queryId, heap->heapNodes[i].docId, i + 1, heap->heapNodes[i].impactScore, RUN_TAG);
+    }
+}
+
+int compareLatencies(const void *a, const void *b) {
+    double latencyA = *(const double *)a;
+    double latencyB = *(const double *)b;
+    return (latencyA > latencyB) - (latencyA < latencyB);
+}
+
+/**
+ * Gets a percentile from sorted latencies using the nearest-rank method
+ * @param sortedLatencies Latencies sorted in ascending order
+ * @param latencyCount Number of latencies
+ * @param percentile Percentile between 0 and 100
+ * @return Latency at the percentile
+ */
+double getLatencyPercentile(const double *sortedLatencies, int latencyCount, double percentile) {
+    int rank = (int)((percentile / 100.0) * latencyCount + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > latencyCount) {
+        rank = latencyCount;
+    }
+    return sortedLatencies[rank - 1];
+}
+
+/**
+ * Runs every query of a query file non-interactively
+ * Queries are evaluated concurrently by a pool of worker threads sharing one engine, then the top-K results of all queries
+ * are written to a TREC run file in query file order and throughput and latency percentiles are reported,
+ * latency covers tokenization and evaluation of a query but not writing its results
+ * @param queryFileName Query file in MS MARCO queries.tsv format
+ * @param runFileName Output run file
+ * @param queryMode Evaluation strategy for all queries
+ * @param approximationFactor Threshold factor for Block-Max WAND
+ * @param threadCount Number of worker threads
+ * @param partitionCount Number of docId ranges each query is split into, 1 to evaluate each query on a single thread
+ */
+void batchQueryProcessor(const char *queryFileName, const char *runFileName, QueryMode queryMode, double approximationFactor, int threadCount, int partitionCount) {
+    int queryCount = 0;
+    BatchQuery *queries = loadBatchQueries(queryFileName, &queryCount);
+    if (queries == NULL) {
+        exit(1);
+    }
+    FILE *runFile = fopen(runFileName, "w");
+    if (runFile == NULL) {
+        printf("Error opening file %s!\n", runFileName);
+        exit(1);
+    }
+    QueryEngine *engine = openQueryEngine();
+    if (engine == NULL) {
+        exit(1);
+    }
+    QueryExecutor *executor = createQueryExecutor(engine, threadCount);
+    if (executor == NULL) {
+        exit(1);
+    }
+    QueryTask *tasks = (QueryTask *)malloc((queryCount > 0 ? queryCount : 1) * sizeof(QueryTask));
+    for (int queryIndex = 0; queryIndex < queryCount; queryIndex++) {
+        tasks[queryIndex].queryText = queries[queryIndex].queryText;
+        tasks[queryIndex].queryMode = queryMode;
+        tasks[queryIndex].approximationFactor = approximationFactor;
+        tasks[queryIndex].partitionCount = partitionCount;
+        tasks[queryIndex].heap = NULL;
+        tasks[queryIndex].latency = 0.0;
+    }
+    struct timespec batchStart, batchEnd;
+    clock_gettime(CLOCK_MONOTONIC, &batchStart);
+    executeQueryTasks(executor, tasks, queryCount);
+    clock_gettime(CLOCK_MONOTONIC, &batchEnd);
+    double elapsed_time = ((double)batchEnd.tv_sec - (double)batchStart.tv_sec) + (batchEnd.tv_nsec - batchStart.tv_nsec) / 1000000000.0;
+    // Write results in query file order and collect latencies
+    double *latencies = (double *)malloc((queryCount > 0 ? queryCount : 1) * sizeof(double));
+    for (int queryIndex = 0; queryIndex < queryCount; queryIndex++) {
+        writeTrecRun(runFile, queries[queryIndex].queryId, tasks[queryIndex].heap);
+        latencies[queryIndex] = tasks[queryIndex].latency;
+        freeHeap(tasks[queryIndex].heap);
+    }
+    printf("File %s written with results of %d queries.\n", runFileName, queryCount);
+    printf("Processed %d queries with %d threads and %d partitions per query in %.6f seconds (%.2f queries per second).\n", queryCount, threadCount, partitionCount, elapsed_time, elapsed_time > 0 ? queryCount / elapsed_time : 0.0);
+    if (queryCount > 0) {
+        qsort(latencies, queryCount, sizeof(double), compareLatencies);
+        printf("Latency p50: %.3f ms, p95: %.3f ms, p99: %.3f ms, max: %.3f ms\n",
+               getLatencyPercentile(latencies, queryCount, 50) * 1000.0,
+               getLatencyPercentile(latencies, queryCount, 95) * 1000.0,
+               getLatencyPercentile(latencies, queryCount, 99) * 1000.0,
+               latencies[queryCount - 1] * 1000.0);
+    }
+    // Clean up
+    free(latencies);
+    free(tasks);
+    freeQueryExecutor(executor);
+    closeQueryEngine(engine);
+    fclose(runFile);
+    freeBatchQueries(queries, queryCount);
+}
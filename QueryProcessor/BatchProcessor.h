@@ -0,0 +1,26 @@
+/* BatchProcessor.h */
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include "QueryEngine.h"
+#include "QueryExecutor.h"
+#include <stdio.h>
+
+/* Run tag written in the last column of the TREC run file */
+#define RUN_TAG "SearchSystem"
+
+/* Query read from a query file in MS MARCO queries.tsv format, i.e., <queryId>\t<queryText> */
+typedef struct BatchQuery {
+    char *queryId;  // Query identifier
+    char *queryText;    // Raw query text
+} BatchQuery;
+
+/* Function prototypes */
+BatchQuery *loadBatchQueries(const char *queryFileName, int *queryCount);   // Load all queries from a query file
+void freeBatchQueries(BatchQuery *queries, int queryCount); // Free memory allocated for loaded queries
+void writeTrecRun(FILE *runFile, const char *queryId, const QueryHeap *heap);   // Write the results of a query in TREC run format
+int compareLatencies(const void *a, const void *b); // Compare two latencies for sorting
+double getLatencyPercentile(const double *sortedLatencies, int latencyCount, double percentile);   // Get a percentile from sorted latencies
+void batchQueryProcessor(const char *queryFileName, const char *runFileName, QueryMode queryMode, double approximationFactor, int threadCount, int partitionCount);  // Run every query of a query file on a thread pool and report throughput and latency
+
+#endif
@@ -1,6 +1,10 @@
 /* Decompression.c */
 #include "Decompression.h"
 #include <math.h>
+#include <string.h>
+#ifdef X86_SIMD_DECODING
+#include <tmmintrin.h>
+#endif
 
 /**
  * Decompresses a variable-byte encoded integer
@@ -14,7 +18,7 @@
  * - High bit 0: Last byte
  * - Lower 7 bits: Data bits
  */
-uint32_t varByteDecompressInt(uint8_t **byteBuffer) {
+uint32_t varByteDecompressInt(const uint8_t **byteBuffer) {
     uint32_t docId = 0;
     size_t shift = 0;
     while (1) {
@@ -37,45 +41,371 @@ uint32_t varByteDecompressInt(uint8_t **byteBuffer) {
  * @param byteBuffer Pointer to current position in byte buffer
  * @return Decompressed impact score
  */
-double logDecompressToDouble(uint8_t **byteBuffer) {
+double logDecompressToDouble(const uint8_t **byteBuffer) {
     uint8_t compressed = **byteBuffer;
+    (*byteBuffer)++;
     if (compressed == 0) {
         return 0.0;
     }
     // Reverse scaling and log compression
     double logImpactScore = (double)compressed / 36.06;
     double impactScore = exp2(logImpactScore) - 1;
-    (*byteBuffer)++;
     return impactScore;
 }
 
 /**
- * Decompresses all postings in current loaded chunk of inverted list
- * Handles both document IDs (VByte) and impact scores (log)
+ * Decompresses a single log compressed impact byte
+ * Used for impact bounds stored outside the chunks, e.g. in the lexicon
+ *
+ * @param compressed Log compressed impact score
+ * @return Decompressed impact score
+ */
+double decompressImpactByte(uint8_t compressed) {
+    const uint8_t *currentByte = &compressed;
+    return logDecompressToDouble(&currentByte);
+}
+
+/**
+ * Decompresses document IDs of current loaded chunk of inverted list
+ * Impact scores are left compressed and only located, see decompressImpactScore
  *
  * @param invertedList List containing compressed postings
  */
 void decompressPostings(InvertedList *invertedList) {
-    uint8_t *currentByte = invertedList->postings;
+    const uint8_t *currentByte = invertedList->postings;
+    if (invertedList->codec == VBYTE_CODEC) {
+        currentByte = decompressVarByteDocIds(invertedList, currentByte);
+    } else if (*currentByte == PARTIAL_CHUNK_MARKER) {
+        // Chunks with fewer postings than a full chunk stay in VByte with the packing codecs
+        currentByte = decompressVarByteDocIds(invertedList, currentByte + 1);
+    } else {
+        currentByte = decompressPackedDocIds(invertedList, currentByte);
+    }
+    // Impact scores follow the document IDs, one byte each
+    invertedList->impactScoreBytes = currentByte;
+    invertedList->isChunkDecompressed = true;
+}
+
+/**
+ * Decompresses VByte encoded document IDs of current loaded chunk
+ * The first document ID is stored as is and the following ones as gaps, the chunk ends at its last document ID
+ *
+ * @param invertedList List containing compressed postings
+ * @param currentByte Start of the compressed document IDs
+ * @return Position right after the compressed document IDs
+ */
+const uint8_t *decompressVarByteDocIds(InvertedList *invertedList, const uint8_t *currentByte) {
     int lastDocId = invertedList->lastDocIds[invertedList->currentChunkIndex];
+    const uint8_t *chunkEnd = invertedList->postings + invertedList->chunkSizes[invertedList->currentChunkIndex];
+    invertedList->postingCount = invertedList->decoder->decodeVarByteDocIds(invertedList->decoder, currentByte, chunkEnd, lastDocId, invertedList->docIds);
+    // Impact scores fill the end of the chunk, one byte per posting
+    return chunkEnd - invertedList->postingCount;
+}
+
+/**
+ * Decodes VByte encoded docIds one byte at a time
+ * The first docId is stored as is and the following ones as gaps
+ *
+ * @param decoder Decoder the routine belongs to, unused
+ * @param currentByte Start of the compressed docIds
+ * @param end End of the chunk, unused
+ * @param lastDocId Last docId of the chunk, decoding stops once it is reached
+ * @param docIds Array of MAX_POSTING_COUNT docIds to fill
+ * @return Number of docIds decoded
+ */
+int decodeVarByteDocIdsScalar(const PostingDecoder *decoder, const uint8_t *currentByte, const uint8_t *end, int lastDocId, int *docIds) {
+    (void)decoder;
+    (void)end;
     int prevDocId = -1;
-    int postingIndex1 = 0;
+    int postingIndex = 0;
     // Decompress delta-gap encoded document IDs
     while (1) {
         int docId = (int)varByteDecompressInt(&currentByte);
         if (prevDocId != -1) {
             docId += prevDocId; // Add delta to previous ID
         }
-        invertedList->docIds[postingIndex1] = docId;
+        docIds[postingIndex] = docId;
         prevDocId = docId;
-        postingIndex1++;
+        postingIndex++;
+        if (docId == lastDocId) {
+            break;
+        }
+    }
+    return postingIndex;
+}
+
+/**
+ * Fills the shuffle table of the shuffle based VByte decoder
+ *
+ * A window of VBYTE_WINDOW_SIZE bytes is described by which of its bytes end an integer, i.e., have the high bit clear.
+ * For every such pattern the table moves the 1 or 2 bytes of each leading integer into its own 16-bit lane,
+ * stopping at the first integer that is longer or does not end within the window.
+ *
+ * @param decoder Decoder whose table to fill
+ */
+void buildVarByteShuffles(PostingDecoder *decoder) {
+    for (int endMask = 0; endMask < (1 << VBYTE_WINDOW_SIZE); endMask++) {
+        VarByteShuffle *shuffle = &decoder->varByteShuffles[endMask];
+        // Lanes without an integer read as zero
+        memset(shuffle->shuffleMask, 0x80, sizeof(shuffle->shuffleMask));
+        int intCount = 0;
+        int intStart = 0;
+        for (int byteIndex = 0; byteIndex < VBYTE_WINDOW_SIZE; byteIndex++) {
+            if ((endMask & (1 << byteIndex)) == 0) {
+                continue;
+            }
+            int intLength = byteIndex - intStart + 1;
+            if (intLength > 2) {
+                break;
+            }
+            shuffle->shuffleMask[2 * intCount] = (uint8_t)intStart;
+            if (intLength == 2) {
+                shuffle->shuffleMask[2 * intCount + 1] = (uint8_t)(intStart + 1);
+            }
+            intCount++;
+            intStart = byteIndex + 1;
+        }
+        shuffle->intCount = (uint8_t)intCount;
+        shuffle->byteCount = (uint8_t)intStart;
+    }
+}
+
+/**
+ * Decompresses bit packed document IDs of current loaded full chunk
+ * Unpacks the gaps with the list's decoder, patches the high bits of PForDelta exceptions and restores the document IDs
+ *
+ * @param invertedList List containing compressed postings
+ * @param currentByte Start of the chunk, at its bit width
+ * @return Position right after the compressed document IDs
+ */
+const uint8_t *decompressPackedDocIds(InvertedList *invertedList, const uint8_t *currentByte) {
+    int bitWidth = *currentByte++;
+    int exceptionCount = 0;
+    if (invertedList->codec == PFOR_DELTA_CODEC) {
+        exceptionCount = *currentByte++;
+    }
+    int firstDocId = (int)varByteDecompressInt(&currentByte);
+    uint32_t values[MAX_POSTING_COUNT];
+    invertedList->decoder->unpackBits(currentByte, bitWidth, values);
+    currentByte += MAX_POSTING_COUNT / 8 * bitWidth;
+    // Patch the values that did not fit in the bit width
+    for (int exceptionIndex = 0; exceptionIndex < exceptionCount; exceptionIndex++) {
+        int position = *currentByte++;
+        values[position] |= varByteDecompressInt(&currentByte) << bitWidth;
+    }
+    invertedList->decoder->restoreDocIds(values, firstDocId, invertedList->docIds);
+    invertedList->postingCount = MAX_POSTING_COUNT;
+    return currentByte;
+}
+
+/**
+ * Unpacks MAX_POSTING_COUNT values bit packed into PACKING_LANE_COUNT interleaved 32-bit lanes
+ * Value i sits in lane i % PACKING_LANE_COUNT, and word k of every lane is stored next to each other
+ *
+ * @param packed Packed words, MAX_POSTING_COUNT / 8 * bitWidth bytes
+ * @param bitWidth Number of bits per value, between 0 and 32
+ * @param values Array of MAX_POSTING_COUNT values to fill
+ */
+void unpackBitsScalar(const uint8_t *packed, int bitWidth, uint32_t *values) {
+    if (bitWidth == 0) {
+        memset(values, 0, sizeof(uint32_t) * MAX_POSTING_COUNT);
+        return;
+    }
+    uint32_t words[MAX_POSTING_COUNT];
+    memcpy(words, packed, MAX_POSTING_COUNT / 8 * bitWidth);
+    uint32_t mask = bitWidth == 32 ? 0xFFFFFFFFu : (1u << bitWidth) - 1;
+    for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT; valueIndex++) {
+        int lane = valueIndex % PACKING_LANE_COUNT;
+        int bitOffset = valueIndex / PACKING_LANE_COUNT * bitWidth;
+        int wordIndex = bitOffset / 32;
+        int shift = bitOffset % 32;
+        uint32_t value = words[wordIndex * PACKING_LANE_COUNT + lane] >> shift;
+        // Take the high bits from the next word of the lane
+        if (shift + bitWidth > 32) {
+            value |= words[(wordIndex + 1) * PACKING_LANE_COUNT + lane] << (32 - shift);
+        }
+        values[valueIndex] = value & mask;
+    }
+}
+
+/**
+ * Turns unpacked docId gaps minus 1 into docIds with a running sum
+ * The first value is 0, as the first docId is stored on its own
+ *
+ * @param values Array of MAX_POSTING_COUNT unpacked values
+ * @param firstDocId First docId of the chunk
+ * @param docIds Array of MAX_POSTING_COUNT docIds to fill
+ */
+void restoreDocIdsScalar(const uint32_t *values, int firstDocId, int *docIds) {
+    int docId = firstDocId - 1;
+    for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT; valueIndex++) {
+        docId += (int)values[valueIndex] + 1;
+        docIds[valueIndex] = docId;
+    }
+}
+
+#ifdef X86_SIMD_DECODING
+/**
+ * Unpacks MAX_POSTING_COUNT values bit packed into PACKING_LANE_COUNT interleaved 32-bit lanes with SSE2
+ * One load brings word k of every lane, so each shift and mask yields four consecutive values
+ *
+ * @param packed Packed words, MAX_POSTING_COUNT / 8 * bitWidth bytes
+ * @param bitWidth Number of bits per value, between 0 and 32
+ * @param values Array of MAX_POSTING_COUNT values to fill
+ */
+__attribute__((target("sse2")))
+void unpackBitsSse2(const uint8_t *packed, int bitWidth, uint32_t *values) {
+    if (bitWidth == 0) {
+        memset(values, 0, sizeof(uint32_t) * MAX_POSTING_COUNT);
+        return;
+    }
+    const __m128i mask = _mm_set1_epi32(bitWidth == 32 ? -1 : (int)((1u << bitWidth) - 1));
+    const __m128i *packedWords = (const __m128i *)packed;
+    for (int position = 0; position < MAX_POSTING_COUNT / PACKING_LANE_COUNT; position++) {
+        int bitOffset = position * bitWidth;
+        int wordIndex = bitOffset / 32;
+        int shift = bitOffset % 32;
+        __m128i lanes = _mm_srl_epi32(_mm_loadu_si128(packedWords + wordIndex), _mm_cvtsi32_si128(shift));
+        // Take the high bits from the next word of every lane
+        if (shift + bitWidth > 32) {
+            lanes = _mm_or_si128(lanes, _mm_sll_epi32(_mm_loadu_si128(packedWords + wordIndex + 1), _mm_cvtsi32_si128(32 - shift)));
+        }
+        _mm_storeu_si128((__m128i *)(values + position * PACKING_LANE_COUNT), _mm_and_si128(lanes, mask));
+    }
+}
+
+/**
+ * Turns unpacked docId gaps minus 1 into docIds with an SSE2 prefix sum
+ * Each group of four values is summed in two shifted adds, then offset by the last docId of the previous group
+ *
+ * @param values Array of MAX_POSTING_COUNT unpacked values
+ * @param firstDocId First docId of the chunk
+ * @param docIds Array of MAX_POSTING_COUNT docIds to fill
+ */
+__attribute__((target("sse2")))
+void restoreDocIdsSse2(const uint32_t *values, int firstDocId, int *docIds) {
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i previousDocIds = _mm_set1_epi32(firstDocId - 1);
+    for (int valueIndex = 0; valueIndex < MAX_POSTING_COUNT; valueIndex += 4) {
+        __m128i gaps = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(values + valueIndex)), one);
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 4));
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 8));
+        __m128i currentDocIds = _mm_add_epi32(gaps, previousDocIds);
+        _mm_storeu_si128((__m128i *)(docIds + valueIndex), currentDocIds);
+        previousDocIds = _mm_shuffle_epi32(currentDocIds, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+}
+
+/**
+ * Decodes VByte encoded docIds a window at a time with PSHUFB and an SSE2 prefix sum
+ *
+ * The high bits of a window give the pattern of integer ends, whose shuffle spreads up to VBYTE_WINDOW_SIZE integers of 1 or 2 bytes
+ * over 16-bit lanes. Their 7-bit halves are joined, widened to 32 bits and summed onto the previous docId.
+ * Longer integers and the last bytes of the chunk are decoded one at a time, the output is identical to decodeVarByteDocIdsScalar.
+ * Lanes past the last docId may decode impact bytes, they are never kept.
+ *
+ * @param decoder Decoder holding the shuffle table
+ * @param currentByte Start of the compressed docIds
+ * @param end End of the chunk, windows are never read past it
+ * @param lastDocId Last docId of the chunk, decoding stops once it is reached
+ * @param docIds Array of MAX_POSTING_COUNT docIds to fill
+ * @return Number of docIds decoded
+ */
+__attribute__((target("ssse3")))
+int decodeVarByteDocIdsSsse3(const PostingDecoder *decoder, const uint8_t *currentByte, const uint8_t *end, int lastDocId, int *docIds) {
+    // Room for the lanes of a last window written past MAX_POSTING_COUNT
+    int decodedDocIds[MAX_POSTING_COUNT + VBYTE_WINDOW_SIZE];
+    const __m128i lowBits = _mm_set1_epi16(0x007F);
+    const __m128i highBits = _mm_set1_epi16(0x3F80);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lastDocIds = _mm_set1_epi32(lastDocId);
+    // Previous docId in every lane
+    __m128i previousDocIds = zero;
+    int postingCount = 0;
+    while (postingCount < MAX_POSTING_COUNT) {
+        if (end - currentByte >= VBYTE_WINDOW_SIZE) {
+            __m128i bytes = _mm_loadl_epi64((const __m128i *)currentByte);
+            int endMask = ~_mm_movemask_epi8(bytes) & ((1 << VBYTE_WINDOW_SIZE) - 1);
+            const VarByteShuffle *shuffle = &decoder->varByteShuffles[endMask];
+            if (shuffle->intCount > 0) {
+                // Join the 7-bit halves of each integer within its lane
+                __m128i lanes = _mm_shuffle_epi8(bytes, _mm_loadu_si128((const __m128i *)shuffle->shuffleMask));
+                lanes = _mm_or_si128(_mm_and_si128(lanes, lowBits), _mm_and_si128(_mm_srli_epi16(lanes, 1), highBits));
+                // Widen to 32 bits and add up the gaps
+                __m128i lowGaps = _mm_unpacklo_epi16(lanes, zero);
+                __m128i highGaps = _mm_unpackhi_epi16(lanes, zero);
+                lowGaps = _mm_add_epi32(lowGaps, _mm_slli_si128(lowGaps, 4));
+                lowGaps = _mm_add_epi32(lowGaps, _mm_slli_si128(lowGaps, 8));
+                highGaps = _mm_add_epi32(highGaps, _mm_slli_si128(highGaps, 4));
+                highGaps = _mm_add_epi32(highGaps, _mm_slli_si128(highGaps, 8));
+                __m128i lowDocIds = _mm_add_epi32(lowGaps, previousDocIds);
+                __m128i highDocIds = _mm_add_epi32(highGaps, _mm_shuffle_epi32(lowDocIds, _MM_SHUFFLE(3, 3, 3, 3)));
+                _mm_storeu_si128((__m128i *)(decodedDocIds + postingCount), lowDocIds);
+                _mm_storeu_si128((__m128i *)(decodedDocIds + postingCount + 4), highDocIds);
+                // Lanes without an integer add nothing, so the last lane holds the last docId of the window
+                previousDocIds = _mm_shuffle_epi32(highDocIds, _MM_SHUFFLE(3, 3, 3, 3));
+                // Stop at the last docId of the chunk if this window reaches it, docIds only grow
+                if (_mm_cvtsi128_si32(previousDocIds) >= lastDocId) {
+                    int matchMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lowDocIds, lastDocIds))) |
+                                    (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(highDocIds, lastDocIds))) << 4);
+                    matchMask &= (1 << shuffle->intCount) - 1;
+                    if (matchMask != 0) {
+                        postingCount += __builtin_ctz(matchMask) + 1;
+                        break;
+                    }
+                }
+                postingCount += shuffle->intCount;
+                currentByte += shuffle->byteCount;
+                continue;
+            }
+        }
+        // Decode a longer integer or the last bytes of the chunk on their own
+        int docId = _mm_cvtsi128_si32(previousDocIds) + (int)varByteDecompressInt(&currentByte);
+        previousDocIds = _mm_set1_epi32(docId);
+        decodedDocIds[postingCount++] = docId;
         if (docId == lastDocId) {
             break;
         }
     }
-    invertedList->postingCount = postingIndex1;
-    // Decompress impact scores
-    for (int postingIndex2 = 0; postingIndex2 < invertedList->postingCount; postingIndex2++) {
-        invertedList->impactScores[postingIndex2] = logDecompressToDouble(&currentByte);
+    // A corrupt chunk never reaching its last docId is cut at the chunk capacity
+    if (postingCount > MAX_POSTING_COUNT) {
+        postingCount = MAX_POSTING_COUNT;
+    }
+    memcpy(docIds, decodedDocIds, sizeof(int) * postingCount);
+    return postingCount;
+}
+#endif
+
+/**
+ * Chooses the fastest decoding routines the CPU supports
+ * Called once when the query engine opens, lists only keep a pointer to the choice
+ *
+ * @param decoder Decoder to fill
+ */
+void selectPostingDecoder(PostingDecoder *decoder) {
+    decoder->unpackBits = unpackBitsScalar;
+    decoder->restoreDocIds = restoreDocIdsScalar;
+    decoder->decodeVarByteDocIds = decodeVarByteDocIdsScalar;
+    buildVarByteShuffles(decoder);
+#ifdef X86_SIMD_DECODING
+    if (__builtin_cpu_supports("sse2")) {
+        decoder->unpackBits = unpackBitsSse2;
+        decoder->restoreDocIds = restoreDocIdsSse2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        decoder->decodeVarByteDocIds = decodeVarByteDocIdsSsse3;
     }
+#endif
+}
+
+/**
+ * Decompresses the impact score of a single posting in current loaded chunk
+ * Only postings that are actually scored pay for the exp2 in logDecompressToDouble
+ *
+ * @param invertedList List whose current chunk has been decompressed
+ * @param postingIndex Index of the posting within the chunk
+ * @return Decompressed impact score
+ */
+double decompressImpactScore(const InvertedList *invertedList, int postingIndex) {
+    return decompressImpactByte(invertedList->impactScoreBytes[postingIndex]);
 }
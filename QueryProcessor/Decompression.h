@@ -5,9 +5,28 @@
 #include "InvertedList.h"
 #include <stdint.h>
 
+/* SIMD decoders are compiled on x86 and chosen at runtime when the CPU supports them */
+#if defined(__x86_64__) || defined(__i386__)
+#define X86_SIMD_DECODING
+#endif
+
 /* Function prototypes */
-void decompressPostings(InvertedList *invertedList);    // Decompress all postings in the current loaded chunk
-uint32_t varByteDecompressInt(uint8_t **byteBuffer);    // Decompress a VByte encoded integer
-double logDecompressToDouble(uint8_t **byteBuffer);    // Decompress a log-encoded double
+void decompressPostings(InvertedList *invertedList);    // Decompress document IDs of the current loaded chunk
+const uint8_t *decompressVarByteDocIds(InvertedList *invertedList, const uint8_t *currentByte); // Decompress VByte document IDs of the current loaded chunk with the list's decoder
+const uint8_t *decompressPackedDocIds(InvertedList *invertedList, const uint8_t *currentByte);  // Decompress bit packed document IDs of the current loaded full chunk
+void unpackBitsScalar(const uint8_t *packed, int bitWidth, uint32_t *values);   // Unpack MAX_POSTING_COUNT interleaved values one lane word at a time
+void restoreDocIdsScalar(const uint32_t *values, int firstDocId, int *docIds);  // Turn docId gaps minus 1 into docIds with a running sum
+int decodeVarByteDocIdsScalar(const PostingDecoder *decoder, const uint8_t *currentByte, const uint8_t *end, int lastDocId, int *docIds);  // Decode VByte docIds one byte at a time
+void buildVarByteShuffles(PostingDecoder *decoder); // Fill the shuffle table of the shuffle based VByte decoder
+#ifdef X86_SIMD_DECODING
+void unpackBitsSse2(const uint8_t *packed, int bitWidth, uint32_t *values); // Unpack MAX_POSTING_COUNT interleaved values four at a time with SSE2
+void restoreDocIdsSse2(const uint32_t *values, int firstDocId, int *docIds);    // Turn docId gaps minus 1 into docIds with an SSE2 prefix sum
+int decodeVarByteDocIdsSsse3(const PostingDecoder *decoder, const uint8_t *currentByte, const uint8_t *end, int lastDocId, int *docIds);   // Decode VByte docIds a window at a time with PSHUFB and an SSE2 prefix sum
+#endif
+void selectPostingDecoder(PostingDecoder *decoder); // Choose the fastest decoding routines the CPU supports
+double decompressImpactByte(uint8_t compressed);    // Decompress a single log-encoded impact byte
+double decompressImpactScore(const InvertedList *invertedList, int postingIndex);   // Decompress the impact score of one posting in the current loaded chunk
+uint32_t varByteDecompressInt(const uint8_t **byteBuffer);  // Decompress a VByte encoded integer
+double logDecompressToDouble(const uint8_t **byteBuffer);  // Decompress a log-encoded double
 
 #endif
@@ -3,16 +3,44 @@
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * Loads block metadata at the current list position and moves the position past it
+ * Metadata is copied because blocks are not aligned to int boundaries in the index file
+ * @param invertedList List to update
+ */
+void loadBlockMetadata(InvertedList *invertedList) {
+    memcpy(invertedList->chunkSizes, invertedList->listPointer, sizeof(int) * MAX_CHUNK_COUNT);
+    invertedList->listPointer += sizeof(int) * MAX_CHUNK_COUNT;
+    memcpy(invertedList->lastDocIds, invertedList->listPointer, sizeof(int) * MAX_CHUNK_COUNT);
+    invertedList->listPointer += sizeof(int) * MAX_CHUNK_COUNT;
+    memcpy(invertedList->maxImpacts, invertedList->listPointer, sizeof(uint8_t) * MAX_CHUNK_COUNT);
+    invertedList->listPointer += sizeof(uint8_t) * MAX_CHUNK_COUNT;
+}
+
+/**
+ * Points the list at the compressed postings of the current chunk and moves the position past them
+ * @param invertedList List to update
+ */
+void loadChunkPostings(InvertedList *invertedList) {
+    invertedList->currentPostingIndex = 0;
+    invertedList->postingCount = 0;
+    invertedList->postings = invertedList->listPointer;
+    invertedList->listPointer += invertedList->chunkSizes[invertedList->currentChunkIndex];
+    // Defer decompression until a docId of this chunk is actually needed
+    invertedList->isChunkDecompressed = false;
+    invertedList->impactScoreBytes = NULL;
+}
+
 /**
  * Creates and initializes a new inverted list for a word
- * Reads initial chunk and block metadata from file
- * @param listPointer File pointer to index
+ * Reads initial chunk and block metadata from the mapped index file
+ * @param blockPointer Position in the mapped index file of the block where the initial chunk is located
  * @param word Word string
  * @param remainingChunkToStart Starting chunk number
  * @param remainingChunkToEnd Ending chunk number
  * @return Initialized inverted list
  */
-InvertedList * createInvertedList(FILE *listPointer, const char *word, int remainingChunkToStart, int remainingChunkToEnd) {
+InvertedList * createInvertedList(const uint8_t *blockPointer, const char *word, int remainingChunkToStart, int remainingChunkToEnd) {
     InvertedList * invertedList = (InvertedList *)malloc(sizeof(InvertedList));
     if (invertedList == NULL) {
         printf("Error allocating memory!\n");
@@ -21,55 +49,37 @@ InvertedList * createInvertedList(FILE *listPointer, const char *word, int remai
     // Initialize word info
     invertedList->word = (char *)malloc(strlen(word) + 1);
     strcpy(invertedList->word, word);
-    invertedList->listPointer = listPointer;
+    invertedList->docCount = 0;
+    invertedList->maxImpactScore = 0.0;
+    invertedList->codec = VBYTE_CODEC;
+    invertedList->decoder = NULL;
+    invertedList->listPointer = blockPointer;
     invertedList->currentChunkIndex = remainingChunkToStart;
     invertedList->remainingChunkCount = remainingChunkToEnd;
     // Read block metadata where the initial chunk is located
-    fread(invertedList->chunkSizes, sizeof(int), MAX_CHUNK_COUNT, listPointer);
-    fread(invertedList->lastDocIds, sizeof(int), MAX_CHUNK_COUNT, listPointer);
+    loadBlockMetadata(invertedList);
     // Skip to the initial chunk
-    int sumSize = 0;
-    for (int chunkIndex = 0; chunkIndex < MAX_CHUNK_COUNT; chunkIndex++) {
-        if (chunkIndex == remainingChunkToStart) {
-            break;
-        }
-        sumSize += invertedList->chunkSizes[chunkIndex];
+    for (int chunkIndex = 0; chunkIndex < remainingChunkToStart; chunkIndex++) {
+        invertedList->listPointer += invertedList->chunkSizes[chunkIndex];
     }
-    fseek(listPointer, sumSize, SEEK_CUR);
     // Initialize postings data of the initial chunk
-    invertedList->currentPostingIndex = 0;
-    invertedList->postingCount = 0;
-    invertedList->postings = malloc(invertedList->chunkSizes[remainingChunkToStart]);
-    fread(invertedList->postings, 1, invertedList->chunkSizes[remainingChunkToStart], listPointer);
-    for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
-        invertedList->docIds[postingIndex] = -1;
-        invertedList->impactScores[postingIndex] = 0.0;
-    }
+    loadChunkPostings(invertedList);
     return invertedList;
 }
 
 /**
  * Frees all memory associated with inverted list
+ * Postings live in the mapped index file and are not owned by the list
  * @param invertedList List to free
  */
 void freeInvertedList(InvertedList *invertedList) {
     free(invertedList->word);
-    fclose(invertedList->listPointer);
-    for (int chunkIndex = 0; chunkIndex < MAX_CHUNK_COUNT; chunkIndex++) {
-        invertedList->chunkSizes[chunkIndex] = 0;
-        invertedList->lastDocIds[chunkIndex] = 0;
-    }
-    free(invertedList->postings);
-    for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
-        invertedList->docIds[postingIndex] = 0;
-        invertedList->impactScores[postingIndex] = 0.0;
-    }
     free(invertedList);
 }
 
 /**
  * Updates inverted list to next chunk
- * Reads new chunk data from file
+ * Moves to the next chunk in the mapped index file
  * @param invertedList List to update
  */
 void updateInvertedListByChunk(InvertedList *invertedList) {
@@ -77,23 +87,14 @@ void updateInvertedListByChunk(InvertedList *invertedList) {
     if (invertedList->currentChunkIndex == MAX_CHUNK_COUNT - 1) {
         invertedList->currentChunkIndex = 0;
         // Read new block metadata
-        fread(invertedList->chunkSizes, sizeof(int), MAX_CHUNK_COUNT, invertedList->listPointer);
-        fread(invertedList->lastDocIds, sizeof(int), MAX_CHUNK_COUNT, invertedList->listPointer);
+        loadBlockMetadata(invertedList);
     } else {
         invertedList->currentChunkIndex++;
     }
     // Update chunk tracking info
     invertedList->remainingChunkCount--;
-    // Read new compressed postings data
-    invertedList->postingCount = 0;
-    free(invertedList->postings);
-    invertedList->postings = malloc(invertedList->chunkSizes[invertedList->currentChunkIndex]);
-    fread(invertedList->postings, 1, invertedList->chunkSizes[invertedList->currentChunkIndex], invertedList->listPointer);
-    // Reset decompressed postings arrays
-    for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
-        invertedList->docIds[postingIndex] = -1;
-        invertedList->impactScores[postingIndex] = 0.0;
-    }
+    // Point at new compressed postings data
+    loadChunkPostings(invertedList);
 }
 
 /**
@@ -103,25 +104,32 @@ void updateInvertedListByChunk(InvertedList *invertedList) {
  */
 void updateInvertedListByBlock(InvertedList *invertedList) {
     // Skip remaining chunks in current block
-    int sumSize = 0;
     for (int chunkIndex = invertedList->currentChunkIndex + 1; chunkIndex < MAX_CHUNK_COUNT; chunkIndex++) {
-        sumSize += invertedList->chunkSizes[chunkIndex];
+        invertedList->listPointer += invertedList->chunkSizes[chunkIndex];
     }
-    fseek(invertedList->listPointer, sumSize, SEEK_CUR);
     // Update block tracking info
     invertedList->remainingChunkCount -= MAX_CHUNK_COUNT - invertedList->currentChunkIndex;
     invertedList->currentChunkIndex = 0;
     // Read new block metadata
-    fread(invertedList->chunkSizes, sizeof(int), MAX_CHUNK_COUNT, invertedList->listPointer);
-    fread(invertedList->lastDocIds, sizeof(int), MAX_CHUNK_COUNT, invertedList->listPointer);
-    // Read new compressed postings data
-    invertedList->postingCount = 0;
-    free(invertedList->postings);
-    invertedList->postings = malloc(invertedList->chunkSizes[invertedList->currentChunkIndex]);
-    fread(invertedList->postings, 1, invertedList->chunkSizes[invertedList->currentChunkIndex], invertedList->listPointer);
-    // Reset decompressed postings arrays
-    for (int postingIndex = 0; postingIndex < MAX_POSTING_COUNT; postingIndex++) {
-        invertedList->docIds[postingIndex] = -1;
-        invertedList->impactScores[postingIndex] = 0.0;
+    loadBlockMetadata(invertedList);
+    // Point at new compressed postings data
+    loadChunkPostings(invertedList);
+}
+
+/**
+ * Updates inverted list to a later chunk within the current block
+ * Skips the chunks in between without touching their postings
+ * @param invertedList List to update
+ * @param chunkIndex Index of the target chunk, greater than the current chunk index
+ */
+void updateInvertedListToChunk(InvertedList *invertedList, int chunkIndex) {
+    // Skip chunks between current and target chunk
+    for (int skippedChunkIndex = invertedList->currentChunkIndex + 1; skippedChunkIndex < chunkIndex; skippedChunkIndex++) {
+        invertedList->listPointer += invertedList->chunkSizes[skippedChunkIndex];
     }
+    // Update chunk tracking info
+    invertedList->remainingChunkCount -= chunkIndex - invertedList->currentChunkIndex;
+    invertedList->currentChunkIndex = chunkIndex;
+    // Point at new compressed postings data
+    loadChunkPostings(invertedList);
 }
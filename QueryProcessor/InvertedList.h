@@ -2,6 +2,7 @@
 #ifndef INVERTED_LIST_H
 #define INVERTED_LIST_H
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 
@@ -9,29 +10,79 @@
 #define MAX_POSTING_COUNT 128
 /* Maximum chunks per block */
 #define MAX_CHUNK_COUNT 64
+/* Magic number written at the start of each index file */
+#define INDEX_FILE_MAGIC 0x58444e49
+/* Size (in bytes) of the header written at the start of each index file, i.e., magic number and codec */
+#define INDEX_FILE_HEADER_SIZE (2 * sizeof(int))
+/* First byte of a chunk holding fewer than MAX_POSTING_COUNT postings in a bit packing or PForDelta index, such chunks stay in VByte */
+#define PARTIAL_CHUNK_MARKER 0xFF
+/* Number of interleaved 32-bit lanes of a bit packed chunk, one SSE register holds a word of every lane */
+#define PACKING_LANE_COUNT 4
+
+/**
+ * Encodings of the docIds of a chunk, read from the header of each index file
+ * Must match the codecs of IndexBuilder
+ */
+typedef enum IndexCodec {
+    VBYTE_CODEC,        // VByte compressed first docId and docId gaps
+    BIT_PACKING_CODEC,  // Full chunks store docId gaps bit packed with a single width, in four interleaved 32-bit lanes
+    PFOR_DELTA_CODEC,   // Full chunks store docId gaps bit packed with a narrower width, larger gaps are patched from exceptions
+    INDEX_CODEC_COUNT   // Number of codecs
+} IndexCodec;
+
+/* Number of VByte encoded bytes looked at by one step of the shuffle based VByte decoder */
+#define VBYTE_WINDOW_SIZE 8
+
+/**
+ * Shuffle decoding one window of VByte encoded bytes, selected by which bytes of the window end an integer
+ */
+typedef struct VarByteShuffle {
+    uint8_t shuffleMask[16];    // PSHUFB mask moving the bytes of each integer into its own 16-bit lane
+    uint8_t intCount;   // Number of complete integers of at most 2 bytes at the start of the window, 0 if the first is longer
+    uint8_t byteCount;  // Number of bytes taken by these integers
+} VarByteShuffle;
+
+/**
+ * Decoding routines for chunks, chosen once for the CPU the queries run on
+ */
+typedef struct PostingDecoder {
+    void (*unpackBits)(const uint8_t *packed, int bitWidth, uint32_t *values);   // Unpack MAX_POSTING_COUNT values of bitWidth bits
+    void (*restoreDocIds)(const uint32_t *values, int firstDocId, int *docIds);  // Turn unpacked docId gaps minus 1 into docIds
+    int (*decodeVarByteDocIds)(const struct PostingDecoder *decoder, const uint8_t *currentByte, const uint8_t *end, int lastDocId, int *docIds);    // Decode VByte docIds up to lastDocId, returning their count
+    VarByteShuffle varByteShuffles[1 << VBYTE_WINDOW_SIZE];  // Shuffle of every pattern of integer ends in a window
+} PostingDecoder;
 
 /**
  * Structure representing a word's inverted list
- * Manages chunk-based reading and decompression
+ * Manages chunk-based reading and decompression directly over the mapped index file
  */
 typedef struct InvertedList {
     char *word;                          // Word string
-    FILE *listPointer;                   // File pointer to index
+    int docCount;                        // Number of documents in the list, from the lexicon
+    double maxImpactScore;               // Largest impact score in the list, from the lexicon
+    const uint8_t *listPointer;          // Position of the next unread data in the mapped index file
     int currentChunkIndex;               // Current chunk being processed
     int remainingChunkCount;             // Chunks left to process
     int chunkSizes[MAX_CHUNK_COUNT];     // Size of each chunk in bytes
     int lastDocIds[MAX_CHUNK_COUNT];     // Last docID in each chunk
+    uint8_t maxImpacts[MAX_CHUNK_COUNT]; // Maximum log compressed impact score in each chunk
     int currentPostingIndex;             // Current posting position
     int postingCount;                    // Number of postings in current chunk
-    uint8_t *postings;                   // Compressed posting data
+    const uint8_t *postings;             // Compressed posting data, points into the mapped index file
+    bool isChunkDecompressed;            // Whether docIds holds the current chunk
     int docIds[MAX_POSTING_COUNT];       // Decompressed document IDs
-    double impactScores[MAX_POSTING_COUNT]; // Decompressed impact scores
+    const uint8_t *impactScoreBytes;     // Compressed impact scores of the current chunk, decoded on demand
+    IndexCodec codec;                    // Codec of the index file holding the list
+    const PostingDecoder *decoder;       // Decoding routines for bit packed chunks, owned by the query engine
 } InvertedList;
 
 /* Function prototypes */
-InvertedList * createInvertedList(FILE *listPointer, const char *word, int remainingChunkToStart, int remainingChunkToEnd); // Create an inverted list
+InvertedList * createInvertedList(const uint8_t *blockPointer, const char *word, int remainingChunkToStart, int remainingChunkToEnd); // Create an inverted list
+void loadBlockMetadata(InvertedList *invertedList);        // Load block metadata at the current position
+void loadChunkPostings(InvertedList *invertedList);        // Point at the compressed postings of the current chunk
 void freeInvertedList(InvertedList *invertedList);        // Free inverted list
 void updateInvertedListByChunk(InvertedList *invertedList); // Update inverted list by chunk
 void updateInvertedListByBlock(InvertedList *invertedList); // Update inverted list by block
+void updateInvertedListToChunk(InvertedList *invertedList, int chunkIndex); // Update inverted list to a later chunk of the current block
 
 #endif
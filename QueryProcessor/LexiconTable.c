@@ -64,8 +64,13 @@ void freeLexiconTable(LexiconTable *lexiconTable) {
  * @param word Word to add
  * @param startChunk First chunk containing word
  * @param endChunk Last chunk containing word
+ * @param docCount Number of documents containing word
+ * @param fileNumber Index file containing word
+ * @param blockOffset Byte offset of the block containing the first chunk
+ * @param chunkIndex Index of the first chunk within that block
+ * @param maxImpact Maximum log compressed impact score in the word's list
  */
-void addEntryToLexiconTable(LexiconTable *lexiconTable, const char *word, int startChunk, int endChunk) {
+void addEntryToLexiconTable(LexiconTable *lexiconTable, const char *word, int startChunk, int endChunk, int docCount, int fileNumber, long blockOffset, int chunkIndex, int maxImpact) {
     int slotIndex = hashFunction(word);
     LexiconEntry *newEntry = (LexiconEntry *)malloc(sizeof(LexiconEntry));
     char *newWord = (char *)malloc(strlen(word) + 1);
@@ -73,6 +78,11 @@ void addEntryToLexiconTable(LexiconTable *lexiconTable, const char *word, int st
     newEntry->word = newWord;
     newEntry->startChunk = startChunk;
     newEntry->endChunk = endChunk;
+    newEntry->docCount = docCount;
+    newEntry->fileNumber = fileNumber;
+    newEntry->blockOffset = blockOffset;
+    newEntry->chunkIndex = chunkIndex;
+    newEntry->maxImpact = maxImpact;
     // Add to front of chain
     newEntry->next = lexiconTable->slots[slotIndex];
     lexiconTable->slots[slotIndex] = newEntry;
@@ -81,7 +91,7 @@ void addEntryToLexiconTable(LexiconTable *lexiconTable, const char *word, int st
 
 /**
  * Parses lexicon file content and builds hash table for lexicon
- * File format: <word> <startChunk> <endChunk>\n
+ * File format: <word> <startChunk> <endChunk> <docCount> <fileNumber> <blockOffset> <chunkIndex> <maxImpact>\n
  *
  * @param lexiconTable Table to populate
  * @param buffer File content buffer
@@ -96,19 +106,18 @@ LexiconTable *convertLexiconFileToLexiconTable(LexiconTable *lexiconTable, char
         char *wordEnd = strchr(word, ' ');
         if (wordEnd) {
             *wordEnd = '\0';    // Temporarily terminate word
-            char *startChunkStr = wordEnd + 1;
-            char *endChunkStr = strchr(startChunkStr, ' ');
-            if (endChunkStr) {
-                *endChunkStr = '\0';
-                endChunkStr++;
-                // Convert chunk numbers
-                int startChunk = (int)strtoll(startChunkStr, NULL, 10);
-                int endChunk = (int)strtoll(endChunkStr, NULL, 10);
-                addEntryToLexiconTable(lexiconTable, word, startChunk, endChunk);
-                // Restore spaces
-                *wordEnd = ' ';
-                *(endChunkStr - 1) = ' ';
-            }
+            // Convert numeric fields one after another
+            char *fieldStart = wordEnd + 1;
+            int startChunk = (int)strtol(fieldStart, &fieldStart, 10);
+            int endChunk = (int)strtol(fieldStart, &fieldStart, 10);
+            int docCount = (int)strtol(fieldStart, &fieldStart, 10);
+            int fileNumber = (int)strtol(fieldStart, &fieldStart, 10);
+            long blockOffset = strtol(fieldStart, &fieldStart, 10);
+            int chunkIndex = (int)strtol(fieldStart, &fieldStart, 10);
+            int maxImpact = (int)strtol(fieldStart, &fieldStart, 10);
+            addEntryToLexiconTable(lexiconTable, word, startChunk, endChunk, docCount, fileNumber, blockOffset, chunkIndex, maxImpact);
+            // Restore space
+            *wordEnd = ' ';
         }
         // Restore newline
         *lineEnd = '\n';
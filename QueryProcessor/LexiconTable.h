@@ -10,6 +10,11 @@ typedef struct LexiconEntry {
     char *word; // Word string
     int startChunk; // Start chunk containing word in index file, starting from 1
     int endChunk;   // End chunk containing word in index file
+    int docCount;   // Number of documents containing word, i.e., document frequency
+    int fileNumber; // Number of the inverted index file containing word
+    long blockOffset;   // Byte offset in the index file of the block containing the start chunk
+    int chunkIndex; // Index of the start chunk within that block
+    int maxImpact;  // Maximum log compressed impact score in the word's list
     struct LexiconEntry *next;  // Pointer to next entry in case of collision
 } LexiconEntry;
 
@@ -23,7 +28,7 @@ typedef struct LexiconTable {
 int hashFunction (const char *word);    // Hash function for generating slot index from a word
 LexiconTable *createLexiconTable(); // Create a new lexicon table
 void freeLexiconTable(LexiconTable *lexiconTable);  // Free memory allocated for lexicon table
-void addEntryToLexiconTable(LexiconTable *lexiconTable, const char *word, int startChunk, int endChunk);    // Add a new word entry to lexicon table
+void addEntryToLexiconTable(LexiconTable *lexiconTable, const char *word, int startChunk, int endChunk, int docCount, int fileNumber, long blockOffset, int chunkIndex, int maxImpact);  // Add a new word entry to lexicon table
 LexiconTable *convertLexiconFileToLexiconTable(LexiconTable *lexiconTable, char *buffer);   // Convert lexicon file in ASCII format to lexicon table
 LexiconEntry *findWordInLexiconTable(const LexiconTable *lexiconTable, const char *word);   // Find a word in the lexicon table
 
@@ -0,0 +1,1063 @@
+/* QueryEngine.c */
+#include "QueryEngine.h"
+#include "Decompression.h"
+#include "../DataParser/DocPage.h"
+#include "../DataParser/Tokenizer.h"
+#include <float.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * Opens the query engine
+ * Loads the lexicon table, maps the inverted index files, loads the document lengths and connects to the document store,
+ * so that all later queries only touch their own posting lists
+ * @return Opened query engine or NULL on error
+ */
+QueryEngine *openQueryEngine() {
+    QueryEngine *engine = (QueryEngine *)malloc(sizeof(QueryEngine));
+    if (engine == NULL) {
+        printf("Error allocating memory!\n");
+        return NULL;
+    }
+    engine->lexiconTable = NULL;
+    engine->indexFileCount = 0;
+    engine->indexFileContents = NULL;
+    engine->indexFileSizes = NULL;
+    engine->indexFileCodecs = NULL;
+    engine->docCount = 0;
+    engine->docLengths = NULL;
+    engine->db = NULL;
+    engine->documentStatement = NULL;
+    pthread_mutex_init(&engine->documentMutex, NULL);
+    // Build lexicon table once for all queries
+    char *buffer = mapLexiconFileFromDisk();
+    if (buffer == NULL) {
+        closeQueryEngine(engine);
+        return NULL;
+    }
+    engine->lexiconTable = createLexiconTable();
+    convertLexiconFileToLexiconTable(engine->lexiconTable, buffer);
+    free(buffer);
+    // Map inverted index files once for all inverted lists, as many as the previous phase wrote
+    int indexFileCount = countIndexFiles();
+    if (indexFileCount == 0) {
+        printf("Error opening file %s!\n", "InvertedIndex0.bin");
+        closeQueryEngine(engine);
+        return NULL;
+    }
+    engine->indexFileContents = (const uint8_t **)calloc(indexFileCount, sizeof(const uint8_t *));
+    engine->indexFileSizes = (size_t *)calloc(indexFileCount, sizeof(size_t));
+    engine->indexFileCodecs = (IndexCodec *)calloc(indexFileCount, sizeof(IndexCodec));
+    if (engine->indexFileContents == NULL || engine->indexFileSizes == NULL || engine->indexFileCodecs == NULL) {
+        printf("Error allocating memory!\n");
+        closeQueryEngine(engine);
+        return NULL;
+    }
+    engine->indexFileCount = indexFileCount;
+    for (int fileNumber = 0; fileNumber < indexFileCount; fileNumber++) {
+        char indexFileName[20];
+        sprintf(indexFileName, "InvertedIndex%d.bin", fileNumber);
+        engine->indexFileContents[fileNumber] = mapIndexFileFromDisk(indexFileName, &engine->indexFileSizes[fileNumber]);
+        if (engine->indexFileContents[fileNumber] == NULL) {
+            closeQueryEngine(engine);
+            return NULL;
+        }
+        if (!readIndexFileHeader(engine->indexFileContents[fileNumber], engine->indexFileSizes[fileNumber], &engine->indexFileCodecs[fileNumber])) {
+            printf("Error reading header of file %s!\n", indexFileName);
+            closeQueryEngine(engine);
+            return NULL;
+        }
+    }
+    selectPostingDecoder(&engine->decoder);
+    // Load document lengths
+    engine->docLengths = loadDocLengthsFromDisk(&engine->docCount);
+    if (engine->docLengths == NULL) {
+        closeQueryEngine(engine);
+        return NULL;
+    }
+    // Connect to document store and prepare document lookup
+    if (sqlite3_open_v2("collection.db", &engine->db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+        printf("Cannot open database %s: %s\n", "collection.db", sqlite3_errmsg(engine->db));
+        closeQueryEngine(engine);
+        return NULL;
+    }
+    const char *sql = "SELECT content FROM documents WHERE doc_id = ?;";
+    if (sqlite3_prepare_v2(engine->db, sql, -1, &engine->documentStatement, NULL) != SQLITE_OK) {
+        printf("Error preparing statement\n");
+        closeQueryEngine(engine);
+        return NULL;
+    }
+    return engine;
+}
+
+/**
+ * Closes the query engine and releases all its resources
+ * Safe to call on a partially opened engine
+ * @param engine Engine to close
+ */
+void closeQueryEngine(QueryEngine *engine) {
+    if (engine == NULL) {
+        return;
+    }
+    if (engine->lexiconTable != NULL) {
+        freeLexiconTable(engine->lexiconTable);
+    }
+    for (int fileNumber = 0; fileNumber < engine->indexFileCount; fileNumber++) {
+        if (engine->indexFileContents[fileNumber] != NULL) {
+            munmap((void *)engine->indexFileContents[fileNumber], engine->indexFileSizes[fileNumber]);
+        }
+    }
+    free(engine->indexFileContents);
+    free(engine->indexFileSizes);
+    free(engine->indexFileCodecs);
+    free(engine->docLengths);
+    sqlite3_finalize(engine->documentStatement);
+    sqlite3_close(engine->db);
+    pthread_mutex_destroy(&engine->documentMutex);
+    free(engine);
+}
+
+/**
+ * Counts the inverted index files written by the previous phase
+ * Files are numbered from 0 without gaps, so counting stops at the first missing one
+ * @return Number of inverted index files
+ */
+int countIndexFiles() {
+    int fileCount = 0;
+    char indexFileName[32];
+    while (true) {
+        sprintf(indexFileName, "InvertedIndex%d.bin", fileCount);
+        if (access(indexFileName, F_OK) != 0) {
+            break;
+        }
+        fileCount++;
+    }
+    return fileCount;
+}
+
+/**
+ * Memory maps lexicon file for efficient access
+ * @return Buffer containing lexicon content
+ */
+char *mapLexiconFileFromDisk() {
+    FILE *lexiconFile = fopen("Lexicon.txt", "r");
+    if (lexiconFile == NULL) {
+        printf("Error opening file %s!\n", "Lexicon.txt");
+        return NULL;
+    }
+    // Get file size
+    fseek(lexiconFile, 0, SEEK_END);
+    size_t fileSize = ftell(lexiconFile);
+    fseek(lexiconFile, 0, SEEK_SET);
+    // Map file to memory
+    char *mappedLexiconFile = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileno(lexiconFile), 0);
+    if (mappedLexiconFile == MAP_FAILED) {
+        printf("Error mapping file to memory!\n");
+        fclose(lexiconFile);
+        return NULL;
+    }
+    // Copy to buffer
+    char *buffer = (char *)malloc(fileSize + 1);
+    memcpy(buffer, mappedLexiconFile, fileSize);
+    buffer[fileSize] = '\0';
+    // Clean up mapped content
+    if (munmap(mappedLexiconFile, fileSize) == -1) {
+        printf("Error unmapping file from memory!\n");
+        fclose(lexiconFile);
+        free(buffer);
+        return NULL;
+    }
+    fclose(lexiconFile);
+    return buffer;
+}
+
+/**
+ * Maps a whole inverted index file into memory read-only
+ * The mapping stays alive for the lifetime of the engine and inverted lists point directly into it
+ * @param indexFileName Name of the index file
+ * @param fileSize Pointer to store the size of the file in bytes
+ * @return Start of the mapping or NULL on error
+ */
+const uint8_t *mapIndexFileFromDisk(const char *indexFileName, size_t *fileSize) {
+    FILE *indexFile = fopen(indexFileName, "rb");
+    if (indexFile == NULL) {
+        printf("Error opening file %s!\n", indexFileName);
+        return NULL;
+    }
+    // Get file size
+    fseek(indexFile, 0, SEEK_END);
+    *fileSize = ftell(indexFile);
+    fseek(indexFile, 0, SEEK_SET);
+    if (*fileSize == 0) {
+        printf("Error mapping empty file %s!\n", indexFileName);
+        fclose(indexFile);
+        return NULL;
+    }
+    // Map file to memory, the mapping outlives the file handle
+    void *mappedIndexFile = mmap(NULL, *fileSize, PROT_READ, MAP_SHARED, fileno(indexFile), 0);
+    fclose(indexFile);
+    if (mappedIndexFile == MAP_FAILED) {
+        printf("Error mapping file %s to memory!\n", indexFileName);
+        return NULL;
+    }
+    return (const uint8_t *)mappedIndexFile;
+}
+
+/**
+ * Reads the codec from the header of a mapped inverted index file
+ * Files written before index files had a header start with the chunk sizes of their first block, which never match the magic number,
+ * they hold VByte chunks and their lexicon offsets already count from the start of the file
+ * @param indexFileContent Mapped inverted index file
+ * @param fileSize Size of the file in bytes
+ * @param codec Set to the codec the chunks of the file are encoded with
+ * @return true if the header is valid
+ */
+bool readIndexFileHeader(const uint8_t *indexFileContent, size_t fileSize, IndexCodec *codec) {
+    int fileHeader[2] = {0, 0};
+    memcpy(fileHeader, indexFileContent, fileSize < INDEX_FILE_HEADER_SIZE ? fileSize : INDEX_FILE_HEADER_SIZE);
+    if (fileHeader[0] != INDEX_FILE_MAGIC) {
+        *codec = VBYTE_CODEC;
+        return true;
+    }
+    if (fileSize < INDEX_FILE_HEADER_SIZE || fileHeader[1] < 0 || fileHeader[1] >= INDEX_CODEC_COUNT) {
+        return false;
+    }
+    *codec = (IndexCodec)fileHeader[1];
+    return true;
+}
+
+/**
+ * Reads document length data from binary file
+ * @param docCount Pointer to store the number of documents read
+ * @return Array of document lengths or NULL on error, caller must free
+ */
+int *loadDocLengthsFromDisk(int *docCount) {
+    FILE *docLengthsFile = fopen("DocLengths.bin", "rb");
+    if (docLengthsFile == NULL) {
+        printf("Error opening file %s!\n", "DocLengths.bin");
+        return NULL;
+    }
+    fseek(docLengthsFile, 0, SEEK_END);
+    size_t fileSize = ftell(docLengthsFile);
+    fseek(docLengthsFile, 0, SEEK_SET);
+    int *docLengths = (int *)malloc(fileSize);
+    if (docLengths == NULL) {
+        printf("Error allocating memory!\n");
+        fclose(docLengthsFile);
+        return NULL;
+    }
+    if (fread(docLengths, 1, fileSize, docLengthsFile) != fileSize) {
+        printf("Error reading file %s!\n", "DocLengths.bin");
+        free(docLengths);
+        fclose(docLengthsFile);
+        return NULL;
+    }
+    fclose(docLengthsFile);
+    *docCount = (int)(fileSize / sizeof(int));
+    return docLengths;
+}
+
+/**
+ * Opens the inverted list of a word
+ * The lexicon records the index file and block offset of every list, so opening costs the same wherever the word sits in the index
+ * @param engine Engine holding the lexicon and index files
+ * @param word Word to open the list for
+ * @return Inverted list positioned at the first chunk of the word, NULL if the word is not in the lexicon
+ */
+InvertedList *openInvertedListForWord(const QueryEngine *engine, const char *word) {
+    // Look up term in lexicon table
+    LexiconEntry *lexiconEntry = findWordInLexiconTable(engine->lexiconTable, word);
+    if (lexiconEntry == NULL) {
+        return NULL;
+    }
+    // Validate the recorded location against the mapped index files
+    if (lexiconEntry->fileNumber < 0 || lexiconEntry->fileNumber >= engine->indexFileCount || lexiconEntry->blockOffset < 0 || (size_t)lexiconEntry->blockOffset >= engine->indexFileSizes[lexiconEntry->fileNumber]) {
+        printf("Error locating inverted list of %s!\n", word);
+        return NULL;
+    }
+    int remainingChunkToEnd = lexiconEntry->endChunk - lexiconEntry->startChunk;
+    const uint8_t *blockPointer = engine->indexFileContents[lexiconEntry->fileNumber] + lexiconEntry->blockOffset;
+    InvertedList *invertedList = createInvertedList(blockPointer, word, lexiconEntry->chunkIndex, remainingChunkToEnd);
+    // Attach list statistics used for query planning and pruning
+    invertedList->docCount = lexiconEntry->docCount;
+    invertedList->maxImpactScore = decompressImpactByte((uint8_t)lexiconEntry->maxImpact);
+    // Decode chunks with the codec of the file
+    invertedList->codec = engine->indexFileCodecs[lexiconEntry->fileNumber];
+    invertedList->decoder = &engine->decoder;
+    return invertedList;
+}
+
+/**
+ * Finds the first position holding a value greater than or equal to target in a sorted range
+ * Gallops forward from the start with doubling steps, then binary searches the last step,
+ * so the cost grows with the distance to the result rather than with the range length
+ * @param sortedValues Array sorted in ascending order
+ * @param startIndex First position of the range
+ * @param endIndex Last position of the range (inclusive)
+ * @param target Target value
+ * @return First position in the range holding a GEQ value, endIndex + 1 if there is none
+ */
+int gallopingSearch(const int *sortedValues, int startIndex, int endIndex, int target) {
+    if (startIndex > endIndex || sortedValues[startIndex] >= target) {
+        return startIndex;
+    }
+    // Gallop until a GEQ value is passed, sortedValues[low] < target holds throughout
+    int low = startIndex;
+    int step = 1;
+    int high = startIndex + step;
+    while (high <= endIndex && sortedValues[high] < target) {
+        low = high;
+        step *= 2;
+        high = startIndex + step;
+    }
+    if (high > endIndex) {
+        if (sortedValues[endIndex] < target) {
+            return endIndex + 1;
+        }
+        high = endIndex;
+    }
+    // Binary search in (low, high], sortedValues[high] >= target
+    while (high - low > 1) {
+        int middle = low + (high - low) / 2;
+        if (sortedValues[middle] < target) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return high;
+}
+
+/**
+ * Moves the list to the chunk that may contain the next document ID greater than or equal to target
+ * Only block metadata is consulted, the chunk itself is not decompressed
+ * @param invertedList List to move
+ * @param docId Target document ID
+ * @return true if the current chunk holds a GEQ document ID, false if the list has none
+ */
+bool skipToChunkGEQ(InvertedList *invertedList, int docId) {
+    // Skip blocks if possible
+    while (invertedList->remainingChunkCount - (MAX_CHUNK_COUNT - (invertedList->currentChunkIndex + 1)) > 0 && invertedList->lastDocIds[MAX_CHUNK_COUNT - 1] < docId) {
+        updateInvertedListByBlock(invertedList);
+    }
+    // Skip chunks if possible, searching the last docIds of the list's chunks left in this block
+    if (invertedList->lastDocIds[invertedList->currentChunkIndex] < docId) {
+        int lastChunkIndex = invertedList->currentChunkIndex + invertedList->remainingChunkCount;
+        if (lastChunkIndex > MAX_CHUNK_COUNT - 1) {
+            lastChunkIndex = MAX_CHUNK_COUNT - 1;
+        }
+        int chunkIndex = gallopingSearch(invertedList->lastDocIds, invertedList->currentChunkIndex + 1, lastChunkIndex, docId);
+        if (chunkIndex > lastChunkIndex) {
+            chunkIndex = lastChunkIndex;
+        }
+        if (chunkIndex != invertedList->currentChunkIndex) {
+            updateInvertedListToChunk(invertedList, chunkIndex);
+        }
+    }
+    return invertedList->lastDocIds[invertedList->currentChunkIndex] >= docId;
+}
+
+/**
+ * Finds next document ID greater than or equal to target
+ * Uses block-level and chunk-level skipping
+ * The current chunk is decompressed at most once and searched from the current posting onwards with galloping search,
+ * since targets never move backwards during document-at-a-time processing
+ * @param invertedList List to search
+ * @param docId Target document ID
+ * @return Next GEQ document ID or -1 if none exists
+ */
+int getNextGEQDocId(InvertedList *invertedList, int docId) {
+    // Skip blocks and chunks if possible
+    if (!skipToChunkGEQ(invertedList, docId)) {
+        return -1;
+    }
+    // Decompress current chunk if not done yet and search from current posting
+    if (!invertedList->isChunkDecompressed) {
+        decompressPostings(invertedList);
+    }
+    int postingIndex = gallopingSearch(invertedList->docIds, invertedList->currentPostingIndex, invertedList->postingCount - 1, docId);
+    if (postingIndex == invertedList->postingCount) {
+        return -1;
+    }
+    invertedList->currentPostingIndex = postingIndex;
+    return invertedList->docIds[postingIndex];
+}
+
+/**
+ * Finds next document ID greater than or equal to target below the end of a document ID range
+ * Documents from endDocId onwards are treated as if the list were exhausted
+ * @param invertedList List to search
+ * @param docId Target document ID
+ * @param endDocId End of the document ID range (exclusive)
+ * @return Next GEQ document ID or -1 if none exists in the range
+ */
+int getNextGEQDocIdInRange(InvertedList *invertedList, int docId, int endDocId) {
+    if (docId >= endDocId) {
+        return -1;
+    }
+    int nextDocId = getNextGEQDocId(invertedList, docId);
+    return nextDocId < endDocId ? nextDocId : -1;
+}
+
+/**
+* Performs conjunctive (AND) document-at-a-time query processing
+* Only documents in [startDocId, endDocId) are considered, so disjoint ranges can be evaluated independently
+* Returns top-K documents containing ALL query terms, ranked by impact score
+* Lists are visited from the shortest to the longest, so candidates come from the rarest term
+* and the cost depends on the shortest list rather than on the order of the query terms
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @param startDocId Start of the document ID range (inclusive)
+* @param endDocId End of the document ID range (exclusive)
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *conjunctiveDocumentAtATimeInRange(const QueryEngine *engine, char **words, int wordCount, int startDocId, int endDocId) {
+    QueryHeap *heap = createHeap();
+    bool anyListExhausted = false;
+    // Allocate and initialize inverted lists for each query term
+    InvertedList **invertedLists = (InvertedList **)malloc(wordCount * sizeof(InvertedList *));
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        invertedLists[wordIndex] = openInvertedListForWord(engine, words[wordIndex]);
+        if (invertedLists[wordIndex] == NULL) {
+            // Term not found - mark list as empty
+            anyListExhausted = true;
+        }
+    }
+    // Early termination if any term not found (conjunctive requires ALL terms)
+    if (anyListExhausted) {
+        // Clean up and return empty result
+        for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+            if (invertedLists[wordIndex] != NULL) {
+                freeInvertedList(invertedLists[wordIndex]);
+            }
+        }
+        free(invertedLists);
+        return heap;
+    }
+    // Order lists by document frequency, insertion sort as queries are short
+    int *frequencyOrder = (int *)malloc(wordCount * sizeof(int));
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        int position = wordIndex;
+        while (position > 0 && invertedLists[frequencyOrder[position - 1]]->docCount > invertedLists[wordIndex]->docCount) {
+            frequencyOrder[position] = frequencyOrder[position - 1];
+            position--;
+        }
+        frequencyOrder[position] = wordIndex;
+    }
+    int resultCount = 0;    // Number of results found
+    int currentDocId = startDocId;   // Current document being examined
+    // Main processing loop
+    while (1) {
+        // Get next candidate from shortest list
+        int candidateDocId = getNextGEQDocIdInRange(invertedLists[frequencyOrder[0]], currentDocId, endDocId);
+        if (candidateDocId == -1) { // Shortest list exhausted
+            anyListExhausted = true;
+            break;
+        }
+        // Check if candidate appears in all other lists, from shortest to longest
+        bool allMatched = true;
+        for (int position = 1; position < wordCount; position++) {
+            int nextDocId = getNextGEQDocIdInRange(invertedLists[frequencyOrder[position]], candidateDocId, endDocId);
+            if (nextDocId == -1) {  // Current list exhausted
+                anyListExhausted = true;
+                break;
+            }
+            if (nextDocId != candidateDocId) {  // Mismatch found
+                allMatched = false;
+                currentDocId = nextDocId;   // Skip to next potential match
+                break;
+            }
+        }
+        // Exit if any list is exhausted
+        if (anyListExhausted) {
+            break;
+        }
+        // Process matching document if found in all lists
+        if (allMatched) {
+            // Calculate total impact score in query order
+            double totalImpactScore = 0.0;
+            for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+                totalImpactScore += decompressImpactScore(invertedLists[wordIndex], invertedLists[wordIndex]->currentPostingIndex);
+            }
+            // Update top-K heap
+            if (resultCount < QUERY_HEAP_SIZE) {
+                // Heap not full - add directly
+                QueryHeapNode heapNode;
+                heapNode.docId = candidateDocId;
+                heapNode.impactScore = totalImpactScore;
+                insertHeapNode(heap, heapNode);
+            } else if (totalImpactScore > heap->heapNodes[0].impactScore) {
+                // Heap full but new score better than minimum - replace minimum
+                extractMin(heap);
+                QueryHeapNode heapNode;
+                heapNode.docId = candidateDocId;
+                heapNode.impactScore = totalImpactScore;
+                insertHeapNode(heap, heapNode);
+            }
+            resultCount++;
+            currentDocId = candidateDocId + 1;  // Move to next document
+        }
+    }
+    // Clean up
+    free(frequencyOrder);
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        freeInvertedList(invertedLists[wordIndex]);
+    }
+    free(invertedLists);
+    // Sort results by impact score
+    heapSort(heap);
+    return heap;
+}
+
+/**
+* Performs conjunctive (AND) document-at-a-time query processing over all documents
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *conjunctiveDocumentAtATime(const QueryEngine *engine, char **words, int wordCount) {
+    return conjunctiveDocumentAtATimeInRange(engine, words, wordCount, 0, INT_MAX);
+}
+
+/**
+* Performs disjunctive (OR) document-at-a-time query processing
+* Only documents in [startDocId, endDocId) are considered, so disjoint ranges can be evaluated independently
+* Returns top-K documents containing ANY query terms, ranked by impact score
+*
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @param startDocId Start of the document ID range (inclusive)
+* @param endDocId End of the document ID range (exclusive)
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *disjunctiveDocumentAtATimeInRange(const QueryEngine *engine, char **words, int wordCount, int startDocId, int endDocId) {
+    QueryHeap *heap = createHeap();
+    // Allocate and initialize inverted lists for each query term, NULL if term not found
+    InvertedList **invertedLists = (InvertedList **)malloc(wordCount * sizeof(InvertedList *));
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        invertedLists[wordIndex] = openInvertedListForWord(engine, words[wordIndex]);
+    }
+    int resultCount = 0;    // Number of results found
+    // Arrays to track current state of each list
+    int *currentDocIds = (int *)malloc(wordCount * sizeof(int));    // Current docId in each list
+    bool *listExhausted = (bool *)malloc(wordCount * sizeof(bool)); // Whether list is exhausted
+    bool allListsExhausted = false; // Whether all lists are exhausted
+    // Initialize each list's state
+    for (int i = 0; i < wordCount; i++) {
+        if (invertedLists[i] != NULL) {
+            // Get first document from list
+            currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], startDocId, endDocId);
+            listExhausted[i] = (currentDocIds[i] == -1);
+        } else {
+            listExhausted[i] = true;
+        }
+    }
+    // Main processing loop
+    while (!allListsExhausted) {
+        // Find minimum document ID among all current positions
+        int minDocId = INT_MAX;
+        for (int i = 0; i < wordCount; i++) {
+            if (!listExhausted[i] && currentDocIds[i] < minDocId) {
+                minDocId = currentDocIds[i];
+            }
+        }
+        // Exit if no more documents
+        if (minDocId == INT_MAX) {
+            break;
+        }
+        // Calculate total impact score for current document
+        double totalImpactScore = 0.0;
+        for (int i = 0; i < wordCount; i++) {
+            if (!listExhausted[i] && currentDocIds[i] == minDocId) {
+                totalImpactScore += decompressImpactScore(invertedLists[i], invertedLists[i]->currentPostingIndex);
+            }
+        }
+        // Update top-K heap
+        if (resultCount < QUERY_HEAP_SIZE) {
+            // Heap not full - add directly
+            QueryHeapNode heapNode;
+            heapNode.docId = minDocId;
+            heapNode.impactScore = totalImpactScore;
+            insertHeapNode(heap, heapNode);
+        } else if (totalImpactScore > heap->heapNodes[0].impactScore) {
+            // Heap full but new score better than minimum - replace minimum
+            extractMin(heap);
+            QueryHeapNode heapNode;
+            heapNode.docId = minDocId;
+            heapNode.impactScore = totalImpactScore;
+            insertHeapNode(heap, heapNode);
+        }
+        resultCount++;
+        // Advance lists that matched current document
+        allListsExhausted = true;
+        for (int i = 0; i < wordCount; i++) {
+            if (!listExhausted[i] && currentDocIds[i] == minDocId) {
+                currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], minDocId + 1, endDocId);
+                listExhausted[i] = (currentDocIds[i] == -1);
+            }
+            if (!listExhausted[i]) {
+                allListsExhausted = false;
+            }
+        }
+    }
+    // Clean up
+    free(currentDocIds);
+    free(listExhausted);
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        if (invertedLists[wordIndex] != NULL) {
+            freeInvertedList(invertedLists[wordIndex]);
+        }
+    }
+    free(invertedLists);
+    // Sort results by impact score
+    heapSort(heap);
+    return heap;
+}
+
+/**
+* Performs disjunctive (OR) document-at-a-time query processing over all documents
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *disjunctiveDocumentAtATime(const QueryEngine *engine, char **words, int wordCount) {
+    return disjunctiveDocumentAtATimeInRange(engine, words, wordCount, 0, INT_MAX);
+}
+
+/**
+* Performs disjunctive (OR) query processing with MaxScore dynamic pruning
+* Only documents in [startDocId, endDocId) are considered, so disjoint ranges can be evaluated independently
+* Returns exactly the same top-K documents as disjunctiveDocumentAtATime while skipping most postings
+*
+* Lists are ordered by their maximum impact score. Once the heap is full, the lists whose summed maximum
+* impact scores cannot exceed the heap's minimum score become non-essential: only documents from the
+* essential lists are candidates, and non-essential lists are merely probed for them, from the largest
+* bound down, until the candidate can no longer enter the heap.
+*
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @param startDocId Start of the document ID range (inclusive)
+* @param endDocId End of the document ID range (exclusive)
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *disjunctiveMaxScoreInRange(const QueryEngine *engine, char **words, int wordCount, int startDocId, int endDocId) {
+    QueryHeap *heap = createHeap();
+    // Open inverted lists of terms found in lexicon, keeping query order
+    InvertedList **invertedLists = (InvertedList **)malloc(wordCount * sizeof(InvertedList *));
+    int listCount = 0;
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        InvertedList *invertedList = openInvertedListForWord(engine, words[wordIndex]);
+        if (invertedList != NULL) {
+            invertedLists[listCount] = invertedList;
+            listCount++;
+        }
+    }
+    // Arrays to track current state of each list
+    int *currentDocIds = (int *)malloc(listCount * sizeof(int));    // Current docId in each list, -1 if exhausted
+    double *impactScores = (double *)malloc(listCount * sizeof(double));    // Impact score of the candidate in each list
+    bool *candidateMatched = (bool *)malloc(listCount * sizeof(bool));  // Whether list contains the candidate
+    int *boundOrder = (int *)malloc(listCount * sizeof(int));   // List indices in ascending order of maximum impact score
+    double *upperBounds = (double *)malloc(listCount * sizeof(double)); // Summed maximum impact scores of the lists in boundOrder up to each position
+    for (int i = 0; i < listCount; i++) {
+        currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], startDocId, endDocId);
+        // Insertion sort by maximum impact score, queries are short
+        int position = i;
+        while (position > 0 && invertedLists[boundOrder[position - 1]]->maxImpactScore > invertedLists[i]->maxImpactScore) {
+            boundOrder[position] = boundOrder[position - 1];
+            position--;
+        }
+        boundOrder[position] = i;
+    }
+    for (int position = 0; position < listCount; position++) {
+        upperBounds[position] = invertedLists[boundOrder[position]]->maxImpactScore + (position > 0 ? upperBounds[position - 1] : 0.0);
+    }
+    int firstEssential = 0; // Position in boundOrder of the first essential list
+    double threshold = -DBL_MAX;    // Score a document has to exceed to enter the full heap
+    // Main processing loop
+    while (firstEssential < listCount) {
+        // Find minimum document ID among essential lists
+        int candidateDocId = INT_MAX;
+        for (int position = firstEssential; position < listCount; position++) {
+            int i = boundOrder[position];
+            if (currentDocIds[i] != -1 && currentDocIds[i] < candidateDocId) {
+                candidateDocId = currentDocIds[i];
+            }
+        }
+        // Exit if no more documents
+        if (candidateDocId == INT_MAX) {
+            break;
+        }
+        // Score the candidate in essential lists and advance them
+        double partialImpactScore = 0.0;
+        for (int i = 0; i < listCount; i++) {
+            candidateMatched[i] = false;
+        }
+        for (int position = firstEssential; position < listCount; position++) {
+            int i = boundOrder[position];
+            if (currentDocIds[i] == candidateDocId) {
+                impactScores[i] = decompressImpactScore(invertedLists[i], invertedLists[i]->currentPostingIndex);
+                candidateMatched[i] = true;
+                partialImpactScore += impactScores[i];
+                currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], candidateDocId + 1, endDocId);
+            }
+        }
+        // Probe non-essential lists while the candidate can still enter the heap
+        bool candidatePruned = false;
+        for (int position = firstEssential - 1; position >= 0; position--) {
+            if (partialImpactScore + upperBounds[position] + PRUNING_EPSILON <= threshold) {
+                candidatePruned = true;
+                break;
+            }
+            int i = boundOrder[position];
+            if (currentDocIds[i] != -1 && currentDocIds[i] < candidateDocId) {
+                currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], candidateDocId, endDocId);
+            }
+            if (currentDocIds[i] == candidateDocId) {
+                impactScores[i] = decompressImpactScore(invertedLists[i], invertedLists[i]->currentPostingIndex);
+                candidateMatched[i] = true;
+                partialImpactScore += impactScores[i];
+            }
+        }
+        if (candidatePruned) {
+            continue;
+        }
+        // Sum impact scores in query order, exactly as the exhaustive evaluation does
+        double totalImpactScore = 0.0;
+        for (int i = 0; i < listCount; i++) {
+            if (candidateMatched[i]) {
+                totalImpactScore += impactScores[i];
+            }
+        }
+        // Update top-K heap
+        if (heap->nodeCount < QUERY_HEAP_SIZE) {
+            // Heap not full - add directly
+            QueryHeapNode heapNode;
+            heapNode.docId = candidateDocId;
+            heapNode.impactScore = totalImpactScore;
+            insertHeapNode(heap, heapNode);
+        } else if (totalImpactScore > heap->heapNodes[0].impactScore) {
+            // Heap full but new score better than minimum - replace minimum
+            extractMin(heap);
+            QueryHeapNode heapNode;
+            heapNode.docId = candidateDocId;
+            heapNode.impactScore = totalImpactScore;
+            insertHeapNode(heap, heapNode);
+        }
+        // Raise threshold and move lists that can no longer lift a document into the heap to non-essential
+        if (heap->nodeCount == QUERY_HEAP_SIZE) {
+            threshold = heap->heapNodes[0].impactScore;
+            while (firstEssential < listCount && upperBounds[firstEssential] + PRUNING_EPSILON <= threshold) {
+                firstEssential++;
+            }
+        }
+    }
+    // Clean up
+    free(currentDocIds);
+    free(impactScores);
+    free(candidateMatched);
+    free(boundOrder);
+    free(upperBounds);
+    for (int i = 0; i < listCount; i++) {
+        freeInvertedList(invertedLists[i]);
+    }
+    free(invertedLists);
+    // Sort results by impact score
+    heapSort(heap);
+    return heap;
+}
+
+/**
+* Performs disjunctive (OR) query processing with MaxScore dynamic pruning over all documents
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *disjunctiveMaxScore(const QueryEngine *engine, char **words, int wordCount) {
+    return disjunctiveMaxScoreInRange(engine, words, wordCount, 0, INT_MAX);
+}
+
+/**
+* Performs disjunctive (OR) query processing with Block-Max WAND dynamic pruning
+* Only documents in [startDocId, endDocId) are considered, so disjoint ranges can be evaluated independently
+* Returns the same top-K documents as disjunctiveDocumentAtATime when approximationFactor is 1.0
+*
+* Lists are kept sorted by their current docId. The pivot is the first document whose summed list-wide
+* maximum impact scores can exceed the heap threshold. Before decompressing anything, the chunks that may
+* hold the pivot are located and their per-chunk maximum impact scores summed; if even that cannot exceed
+* the threshold, all those chunks are skipped as a whole.
+*
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @param approximationFactor Factor (>= 1.0) applied to the heap threshold, larger values prune more aggressively at the cost of recall
+* @param startDocId Start of the document ID range (inclusive)
+* @param endDocId End of the document ID range (exclusive)
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *disjunctiveBlockMaxWandInRange(const QueryEngine *engine, char **words, int wordCount, double approximationFactor, int startDocId, int endDocId) {
+    QueryHeap *heap = createHeap();
+    // Open inverted lists of terms found in lexicon, keeping query order
+    InvertedList **invertedLists = (InvertedList **)malloc(wordCount * sizeof(InvertedList *));
+    int listCount = 0;
+    for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        InvertedList *invertedList = openInvertedListForWord(engine, words[wordIndex]);
+        if (invertedList != NULL) {
+            invertedLists[listCount] = invertedList;
+            listCount++;
+        }
+    }
+    // Arrays to track current state of each list
+    int *currentDocIds = (int *)malloc(listCount * sizeof(int));    // Current docId in each list, INT_MAX if exhausted
+    int *docIdOrder = (int *)malloc(listCount * sizeof(int));   // List indices in ascending order of current docId
+    for (int i = 0; i < listCount; i++) {
+        currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], startDocId, endDocId);
+        if (currentDocIds[i] == -1) {
+            currentDocIds[i] = INT_MAX;
+        }
+        docIdOrder[i] = i;
+    }
+    double threshold = -DBL_MAX;    // Score a document has to exceed to be worth evaluating
+    // Main processing loop
+    while (1) {
+        // Keep lists sorted by current docId, insertion sort as only a few lists move per step
+        for (int position = 1; position < listCount; position++) {
+            int i = docIdOrder[position];
+            int previousPosition = position - 1;
+            while (previousPosition >= 0 && currentDocIds[docIdOrder[previousPosition]] > currentDocIds[i]) {
+                docIdOrder[previousPosition + 1] = docIdOrder[previousPosition];
+                previousPosition--;
+            }
+            docIdOrder[previousPosition + 1] = i;
+        }
+        // Find pivot list whose accumulated list-wide bounds exceed the threshold
+        double upperBound = 0.0;
+        int pivotPosition = -1;
+        for (int position = 0; position < listCount; position++) {
+            int i = docIdOrder[position];
+            if (currentDocIds[i] == INT_MAX) {
+                break;
+            }
+            upperBound += invertedLists[i]->maxImpactScore;
+            if (upperBound + PRUNING_EPSILON > threshold) {
+                pivotPosition = position;
+                break;
+            }
+        }
+        // Exit if no remaining document can enter the heap
+        if (pivotPosition == -1) {
+            break;
+        }
+        int pivotDocId = currentDocIds[docIdOrder[pivotPosition]];
+        // Lists already positioned at the pivot take part in it as well
+        while (pivotPosition + 1 < listCount && currentDocIds[docIdOrder[pivotPosition + 1]] == pivotDocId) {
+            pivotPosition++;
+        }
+        // Sum the chunk-wide bounds of the chunks that may hold the pivot, without decompressing them
+        double blockUpperBound = 0.0;
+        for (int position = 0; position <= pivotPosition; position++) {
+            InvertedList *invertedList = invertedLists[docIdOrder[position]];
+            if (skipToChunkGEQ(invertedList, pivotDocId)) {
+                blockUpperBound += decompressImpactByte(invertedList->maxImpacts[invertedList->currentChunkIndex]);
+            }
+        }
+        if (blockUpperBound + PRUNING_EPSILON > threshold) {
+            if (currentDocIds[docIdOrder[0]] == pivotDocId) {
+                // All lists up to the pivot are at the pivot document, sum impact scores in query order
+                double totalImpactScore = 0.0;
+                for (int i = 0; i < listCount; i++) {
+                    if (currentDocIds[i] == pivotDocId) {
+                        totalImpactScore += decompressImpactScore(invertedLists[i], invertedLists[i]->currentPostingIndex);
+                    }
+                }
+                // Update top-K heap
+                if (heap->nodeCount < QUERY_HEAP_SIZE) {
+                    // Heap not full - add directly
+                    QueryHeapNode heapNode;
+                    heapNode.docId = pivotDocId;
+                    heapNode.impactScore = totalImpactScore;
+                    insertHeapNode(heap, heapNode);
+                } else if (totalImpactScore > heap->heapNodes[0].impactScore) {
+                    // Heap full but new score better than minimum - replace minimum
+                    extractMin(heap);
+                    QueryHeapNode heapNode;
+                    heapNode.docId = pivotDocId;
+                    heapNode.impactScore = totalImpactScore;
+                    insertHeapNode(heap, heapNode);
+                }
+                if (heap->nodeCount == QUERY_HEAP_SIZE) {
+                    threshold = heap->heapNodes[0].impactScore * approximationFactor;
+                }
+                // Advance lists that matched the pivot document
+                for (int i = 0; i < listCount; i++) {
+                    if (currentDocIds[i] == pivotDocId) {
+                        currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], pivotDocId + 1, endDocId);
+                        if (currentDocIds[i] == -1) {
+                            currentDocIds[i] = INT_MAX;
+                        }
+                    }
+                }
+            } else {
+                // Documents before the pivot cannot enter the heap, move lagging lists up to the pivot
+                for (int position = 0; position < pivotPosition; position++) {
+                    int i = docIdOrder[position];
+                    if (currentDocIds[i] < pivotDocId) {
+                        currentDocIds[i] = getNextGEQDocIdInRange(invertedLists[i], pivotDocId, endDocId);
+                        if (currentDocIds[i] == -1) {
+                            currentDocIds[i] = INT_MAX;
+                        }
+                    }
+                }
+            }
+        } else {
+            // No document before the end of the shortest of these chunks can enter the heap, skip past it
+            int nextDocId = (pivotPosition + 1 < listCount) ? currentDocIds[docIdOrder[pivotPosition + 1]] : INT_MAX;
+            for (int position = 0; position <= pivotPosition; position++) {
+                InvertedList *invertedList = invertedLists[docIdOrder[position]];
+                int chunkLastDocId = invertedList->lastDocIds[invertedList->currentChunkIndex];
+                if (chunkLastDocId >= pivotDocId && chunkLastDocId < nextDocId - 1) {
+                    nextDocId = chunkLastDocId + 1;
+                }
+            }
+            for (int position = 0; position <= pivotPosition; position++) {
+                int i = docIdOrder[position];
+                currentDocIds[i] = (nextDocId == INT_MAX) ? -1 : getNextGEQDocIdInRange(invertedLists[i], nextDocId, endDocId);
+                if (currentDocIds[i] == -1) {
+                    currentDocIds[i] = INT_MAX;
+                }
+            }
+        }
+    }
+    // Clean up
+    free(currentDocIds);
+    free(docIdOrder);
+    for (int i = 0; i < listCount; i++) {
+        freeInvertedList(invertedLists[i]);
+    }
+    free(invertedLists);
+    // Sort results by impact score
+    heapSort(heap);
+    return heap;
+}
+
+/**
+* Performs disjunctive (OR) query processing with Block-Max WAND dynamic pruning over all documents
+* @param engine Query engine holding the lexicon and index files
+* @param words Array of query terms
+* @param wordCount Number of query terms
+* @param approximationFactor Factor (>= 1.0) applied to the heap threshold, larger values prune more aggressively at the cost of recall
+* @return Heap containing top-K results sorted by impact score
+*/
+QueryHeap *disjunctiveBlockMaxWand(const QueryEngine *engine, char **words, int wordCount, double approximationFactor) {
+    return disjunctiveBlockMaxWandInRange(engine, words, wordCount, approximationFactor, 0, INT_MAX);
+}
+
+/**
+ * Performs a query with the chosen evaluation strategy over a document ID range
+ * @param engine Query engine holding the lexicon and index files
+ * @param words Array of query terms
+ * @param wordCount Number of query terms
+ * @param queryMode Evaluation strategy
+ * @param approximationFactor Threshold factor for Block-Max WAND, 1.0 for exact results, ignored by other strategies
+ * @param startDocId Start of the document ID range (inclusive)
+ * @param endDocId End of the document ID range (exclusive)
+ * @return Heap containing top-K results sorted by impact score
+ */
+QueryHeap *processQueryInRange(const QueryEngine *engine, char **words, int wordCount, QueryMode queryMode, double approximationFactor, int startDocId, int endDocId) {
+    switch (queryMode) {
+        case CONJUNCTIVE_MODE:
+            return conjunctiveDocumentAtATimeInRange(engine, words, wordCount, startDocId, endDocId);
+        case DISJUNCTIVE_MODE:
+            return disjunctiveDocumentAtATimeInRange(engine, words, wordCount, startDocId, endDocId);
+        case MAX_SCORE_MODE:
+            return disjunctiveMaxScoreInRange(engine, words, wordCount, startDocId, endDocId);
+        case BLOCK_MAX_WAND_MODE:
+            return disjunctiveBlockMaxWandInRange(engine, words, wordCount, approximationFactor, startDocId, endDocId);
+    }
+    return createHeap();
+}
+
+/**
+ * Performs a query with the chosen evaluation strategy over all documents
+ * @param engine Query engine holding the lexicon and index files
+ * @param words Array of query terms
+ * @param wordCount Number of query terms
+ * @param queryMode Evaluation strategy
+ * @param approximationFactor Threshold factor for Block-Max WAND, 1.0 for exact results, ignored by other strategies
+ * @return Heap containing top-K results sorted by impact score
+ */
+QueryHeap *processQuery(const QueryEngine *engine, char **words, int wordCount, QueryMode queryMode, double approximationFactor) {
+    return processQueryInRange(engine, words, wordCount, queryMode, approximationFactor, 0, INT_MAX);
+}
+
+/**
+ * Retrieves document content by docId through the engine's prepared statement
+ * @param engine Query engine holding the document store
+ * @param docId Document ID to retrieve
+ * @return Newly allocated document content, or NULL if not found, caller must free
+ */
+char *getDocumentFromEngine(const QueryEngine *engine, int docId) {
+    // The statement is shared by all threads, only one of them may bind and step it at a time
+    pthread_mutex_t *documentMutex = (pthread_mutex_t *)&engine->documentMutex;
+    pthread_mutex_lock(documentMutex);
+    char *content = getDocumentByDocIdWithStatement(engine->documentStatement, docId);
+    pthread_mutex_unlock(documentMutex);
+    return content;
+}
+
+/**
+* Splits string into an array of unique words at non-alphanumeric characters
+* Uses the same block tokenizer as the data parser, so queries and documents are tokenized identically
+* Reentrant, so it can be called from several queries at once
+* @param input Input string (not modified)
+* @param wordCount Pointer to store the final word count
+* @return Array of unique word strings
+*/
+char **splitIntoWords(char *input, int *wordCount) {
+    // Upper bound on the word count, every word is followed by a separator or the end
+    int maxWords = (int)(strlen(input) / 2) + 1;
+    char **words = (char **)malloc(maxWords * sizeof(char *));
+    *wordCount = 0;
+    // Tokenize exactly as documents are tokenized by the data parser
+    TokenScanner scanner;
+    initTokenScanner(&scanner, input, input + strlen(input));
+    int tokenLength;
+    const char *token;
+    while ((token = nextToken(&scanner, &tokenLength)) != NULL) {
+        // Check if word already exists
+        bool isDuplicate = false;
+        for (int i = 0; i < *wordCount; i++) {
+            if ((int)strlen(words[i]) == tokenLength && memcmp(words[i], token, tokenLength) == 0) {
+                isDuplicate = true;
+                break;
+            }
+        }
+        // Add to array if not a duplicate
+        if (!isDuplicate) {
+            words[*wordCount] = strndup(token, tokenLength);
+            (*wordCount)++;
+        }
+    }
+    return words;
+}
+
+/**
+ * Frees an array of words returned by splitIntoWords
+ * @param words Array of words
+ * @param wordCount Number of words in the array
+ */
+void freeWords(char **words, int wordCount) {
+    for (int i = 0; i < wordCount; i++) {
+        free(words[i]);
+    }
+    free(words);
+}
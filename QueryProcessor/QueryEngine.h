@@ -0,0 +1,71 @@
+/* QueryEngine.h */
+#ifndef QUERY_ENGINE_H
+#define QUERY_ENGINE_H
+
+#include "InvertedList.h"
+#include "LexiconTable.h"
+#include "QueryHeap.h"
+#include <pthread.h>
+#include <sqlite3.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Slack added to score upper bounds before pruning, so floating point rounding never prunes a document that would enter the top-K */
+#define PRUNING_EPSILON 1e-9
+
+/* Query evaluation strategies selectable through processQuery */
+typedef enum QueryMode {
+    CONJUNCTIVE_MODE,       // AND query, conjunctiveDocumentAtATime
+    DISJUNCTIVE_MODE,       // OR query scoring every document, disjunctiveDocumentAtATime
+    MAX_SCORE_MODE,         // OR query with MaxScore pruning, disjunctiveMaxScore
+    BLOCK_MAX_WAND_MODE     // OR query with Block-Max WAND pruning, disjunctiveBlockMaxWand
+} QueryMode;
+
+/**
+ * Long-lived query engine handle
+ * Holds everything a query needs that does not change between queries, so it is opened once and shared by any number of queries
+ * Queries only read the engine and keep their cursors and result heaps to themselves, so they may run on several threads at once
+ */
+typedef struct QueryEngine {
+    LexiconTable *lexiconTable;                 // Lexicon hash table for term lookup
+    int indexFileCount;                         // Number of inverted index files written by the previous phase
+    const uint8_t **indexFileContents;          // Read-only mappings of the inverted index files, shared by all inverted lists
+    size_t *indexFileSizes;                     // Size of each inverted index file in bytes
+    IndexCodec *indexFileCodecs;                // Codec of each inverted index file, from its header
+    PostingDecoder decoder;                     // Decoding routines chosen for the CPU, shared by all inverted lists
+    int docCount;                               // Number of entries in docLengths
+    int *docLengths;                            // Length of each document
+    sqlite3 *db;                                // Document store connection
+    sqlite3_stmt *documentStatement;            // Prepared statement for fetching documents by docId
+    pthread_mutex_t documentMutex;              // Serializes use of the prepared statement across threads
+} QueryEngine;
+
+/* Function prototypes */
+QueryEngine *openQueryEngine(); // Open the query engine, loading lexicon, mapping index files, loading document lengths and document store
+void closeQueryEngine(QueryEngine *engine); // Close the query engine and release all its resources
+int countIndexFiles();  // Count the inverted index files written by the previous phase
+char *mapLexiconFileFromDisk(); // Load lexicon file from disk
+const uint8_t *mapIndexFileFromDisk(const char *indexFileName, size_t *fileSize);  // Map an inverted index file into memory
+bool readIndexFileHeader(const uint8_t *indexFileContent, size_t fileSize, IndexCodec *codec);   // Read the codec from the header of a mapped inverted index file
+int *loadDocLengthsFromDisk(int *docCount); // Load document lengths from disk
+InvertedList *openInvertedListForWord(const QueryEngine *engine, const char *word);    // Open the inverted list of a word, NULL if the word is not in the lexicon
+int gallopingSearch(const int *sortedValues, int startIndex, int endIndex, int target);  // Find the first position holding a GEQ value by galloping then binary search
+bool skipToChunkGEQ(InvertedList *invertedList, int docId);  // Move to the chunk that may hold the next GEQ docId without decompressing it
+int getNextGEQDocId(InvertedList *invertedList, int docId); // Get the next GEQ docId in the inverted list
+int getNextGEQDocIdInRange(InvertedList *invertedList, int docId, int endDocId);    // Get the next GEQ docId in the inverted list below endDocId
+QueryHeap *conjunctiveDocumentAtATimeInRange(const QueryEngine *engine, char **words, int wordCount, int startDocId, int endDocId);    // Perform conjunctive query processing over a docId range
+QueryHeap *disjunctiveDocumentAtATimeInRange(const QueryEngine *engine, char **words, int wordCount, int startDocId, int endDocId);    // Perform disjunctive query processing over a docId range
+QueryHeap *disjunctiveMaxScoreInRange(const QueryEngine *engine, char **words, int wordCount, int startDocId, int endDocId);    // Perform disjunctive query processing with MaxScore over a docId range
+QueryHeap *disjunctiveBlockMaxWandInRange(const QueryEngine *engine, char **words, int wordCount, double approximationFactor, int startDocId, int endDocId);    // Perform disjunctive query processing with Block-Max WAND over a docId range
+QueryHeap *conjunctiveDocumentAtATime(const QueryEngine *engine, char **words, int wordCount);  // Perform conjunctive query processing, aka AND query
+QueryHeap *disjunctiveDocumentAtATime(const QueryEngine *engine, char **words, int wordCount);  // Perform disjunctive query processing, aka OR query
+QueryHeap *disjunctiveMaxScore(const QueryEngine *engine, char **words, int wordCount);  // Perform disjunctive query processing with MaxScore dynamic pruning
+QueryHeap *disjunctiveBlockMaxWand(const QueryEngine *engine, char **words, int wordCount, double approximationFactor);  // Perform disjunctive query processing with Block-Max WAND dynamic pruning
+QueryHeap *processQueryInRange(const QueryEngine *engine, char **words, int wordCount, QueryMode queryMode, double approximationFactor, int startDocId, int endDocId);    // Perform a query with the chosen evaluation strategy over a docId range
+QueryHeap *processQuery(const QueryEngine *engine, char **words, int wordCount, QueryMode queryMode, double approximationFactor);  // Perform a query with the chosen evaluation strategy
+char *getDocumentFromEngine(const QueryEngine *engine, int docId);   // Get document content by docId from the document store, thread-safe
+char **splitIntoWords(char *input, int *wordCount); // Split a query string into an array of unique words
+void freeWords(char **words, int wordCount);    // Free an array of words returned by splitIntoWords
+
+#endif
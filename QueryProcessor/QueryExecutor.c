@@ -0,0 +1,219 @@
+/* QueryExecutor.c */
+#include "QueryExecutor.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Evaluates a single query and records its results and latency
+ * Only reads the engine, so any number of tasks can run at once
+ * @param engine Shared query engine
+ * @param task Task to evaluate
+ */
+void runQueryTask(const QueryEngine *engine, QueryTask *task) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int wordCount;
+    char **words = splitIntoWords(task->queryText, &wordCount);
+    if (task->partitionCount > 1) {
+        task->heap = processQueryInParallel(engine, words, wordCount, task->queryMode, task->approximationFactor, task->partitionCount);
+    } else {
+        task->heap = processQuery(engine, words, wordCount, task->queryMode, task->approximationFactor);
+    }
+    freeWords(words, wordCount);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    task->latency = ((double)end.tv_sec - (double)start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+/**
+ * Worker thread loop
+ * Waits for a batch, claims tasks from it until none is left, then reports back and waits for the next batch
+ * @param arg Query executor
+ * @return NULL
+ */
+void *queryWorker(void *arg) {
+    QueryExecutor *executor = (QueryExecutor *)arg;
+    int seenBatchNumber = 0;
+    pthread_mutex_lock(&executor->mutex);
+    while (true) {
+        while (!executor->isShuttingDown && executor->batchNumber == seenBatchNumber) {
+            pthread_cond_wait(&executor->batchReady, &executor->mutex);
+        }
+        if (executor->isShuttingDown) {
+            break;
+        }
+        seenBatchNumber = executor->batchNumber;
+        QueryTask *tasks = executor->tasks;
+        int taskCount = executor->taskCount;
+        pthread_mutex_unlock(&executor->mutex);
+        // Claim tasks one at a time so long queries do not hold up a fixed share of the batch
+        int taskIndex;
+        while ((taskIndex = atomic_fetch_add(&executor->nextTaskIndex, 1)) < taskCount) {
+            runQueryTask(executor->engine, &tasks[taskIndex]);
+        }
+        pthread_mutex_lock(&executor->mutex);
+        if (--executor->activeThreadCount == 0) {
+            pthread_cond_signal(&executor->batchDone);
+        }
+    }
+    pthread_mutex_unlock(&executor->mutex);
+    return NULL;
+}
+
+/**
+ * Creates a query executor and starts its worker threads
+ * @param engine Shared query engine, must stay open until the executor is freed
+ * @param threadCount Number of worker threads, between 1 and MAX_QUERY_THREAD_COUNT
+ * @return Query executor or NULL on error
+ */
+QueryExecutor *createQueryExecutor(const QueryEngine *engine, int threadCount) {
+    if (threadCount < 1 || threadCount > MAX_QUERY_THREAD_COUNT) {
+        printf("Error invalid thread count %d!\n", threadCount);
+        return NULL;
+    }
+    QueryExecutor *executor = (QueryExecutor *)malloc(sizeof(QueryExecutor));
+    if (executor == NULL) {
+        printf("Error allocating memory!\n");
+        return NULL;
+    }
+    executor->engine = engine;
+    executor->threadCount = 0;
+    executor->threads = (pthread_t *)malloc(threadCount * sizeof(pthread_t));
+    pthread_mutex_init(&executor->mutex, NULL);
+    pthread_cond_init(&executor->batchReady, NULL);
+    pthread_cond_init(&executor->batchDone, NULL);
+    executor->tasks = NULL;
+    executor->taskCount = 0;
+    atomic_init(&executor->nextTaskIndex, 0);
+    executor->batchNumber = 0;
+    executor->activeThreadCount = 0;
+    executor->isShuttingDown = false;
+    for (int threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+        if (pthread_create(&executor->threads[threadIndex], NULL, queryWorker, executor) != 0) {
+            printf("Error creating thread!\n");
+            freeQueryExecutor(executor);
+            return NULL;
+        }
+        executor->threadCount++;
+    }
+    return executor;
+}
+
+/**
+ * Stops the worker threads and frees the query executor
+ * @param executor Query executor to free
+ */
+void freeQueryExecutor(QueryExecutor *executor) {
+    if (executor == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&executor->mutex);
+    executor->isShuttingDown = true;
+    pthread_cond_broadcast(&executor->batchReady);
+    pthread_mutex_unlock(&executor->mutex);
+    for (int threadIndex = 0; threadIndex < executor->threadCount; threadIndex++) {
+        pthread_join(executor->threads[threadIndex], NULL);
+    }
+    pthread_cond_destroy(&executor->batchDone);
+    pthread_cond_destroy(&executor->batchReady);
+    pthread_mutex_destroy(&executor->mutex);
+    free(executor->threads);
+    free(executor);
+}
+
+/**
+ * Evaluates a batch of queries on the worker threads and waits for all of them
+ * Each task gets its own result heap, which the caller frees with freeHeap
+ * @param executor Query executor
+ * @param tasks Tasks to evaluate
+ * @param taskCount Number of tasks
+ */
+void executeQueryTasks(QueryExecutor *executor, QueryTask *tasks, int taskCount) {
+    pthread_mutex_lock(&executor->mutex);
+    executor->tasks = tasks;
+    executor->taskCount = taskCount;
+    atomic_store(&executor->nextTaskIndex, 0);
+    executor->activeThreadCount = executor->threadCount;
+    executor->batchNumber++;
+    pthread_cond_broadcast(&executor->batchReady);
+    while (executor->activeThreadCount > 0) {
+        pthread_cond_wait(&executor->batchDone, &executor->mutex);
+    }
+    executor->tasks = NULL;
+    executor->taskCount = 0;
+    pthread_mutex_unlock(&executor->mutex);
+}
+
+/**
+ * Thread evaluating one docId range of a query
+ * @param arg Query partition
+ * @return NULL
+ */
+void *queryPartitionWorker(void *arg) {
+    QueryPartition *partition = (QueryPartition *)arg;
+    partition->heap = processQueryInRange(partition->engine, partition->words, partition->wordCount, partition->queryMode,
+                                          partition->approximationFactor, partition->startDocId, partition->endDocId);
+    return NULL;
+}
+
+/**
+ * Performs a query split into disjoint docId ranges evaluated on separate threads
+ * Every range opens its own cursors, which skip straight into the range through the lastDocIds metadata,
+ * and collects its own top-K, the partial heaps are merged at the end.
+ * Dynamic pruning works per range, so each range starts with an empty heap and a lower threshold than a single pass would have
+ * @param engine Shared query engine
+ * @param words Array of query terms
+ * @param wordCount Number of query terms
+ * @param queryMode Evaluation strategy
+ * @param approximationFactor Threshold factor for Block-Max WAND
+ * @param partitionCount Number of docId ranges, the calling thread evaluates the first one
+ * @return Heap containing top-K results sorted by impact score
+ */
+QueryHeap *processQueryInParallel(const QueryEngine *engine, char **words, int wordCount, QueryMode queryMode, double approximationFactor, int partitionCount) {
+    if (partitionCount < 1) {
+        partitionCount = 1;
+    }
+    QueryPartition *partitions = (QueryPartition *)malloc(partitionCount * sizeof(QueryPartition));
+    pthread_t *threads = (pthread_t *)malloc(partitionCount * sizeof(pthread_t));
+    bool *threadStarted = (bool *)malloc(partitionCount * sizeof(bool));
+    // Split docIds 0 to docCount evenly, the last range is open-ended
+    long long docIdSpan = (long long)engine->docCount + 1;
+    for (int partitionIndex = 0; partitionIndex < partitionCount; partitionIndex++) {
+        partitions[partitionIndex].engine = engine;
+        partitions[partitionIndex].words = words;
+        partitions[partitionIndex].wordCount = wordCount;
+        partitions[partitionIndex].queryMode = queryMode;
+        partitions[partitionIndex].approximationFactor = approximationFactor;
+        partitions[partitionIndex].startDocId = (int)(docIdSpan * partitionIndex / partitionCount);
+        partitions[partitionIndex].endDocId = (partitionIndex == partitionCount - 1) ? INT_MAX : (int)(docIdSpan * (partitionIndex + 1) / partitionCount);
+        partitions[partitionIndex].heap = NULL;
+    }
+    for (int partitionIndex = 1; partitionIndex < partitionCount; partitionIndex++) {
+        threadStarted[partitionIndex] = (pthread_create(&threads[partitionIndex], NULL, queryPartitionWorker, &partitions[partitionIndex]) == 0);
+    }
+    // Evaluate the first range here, and any range whose thread could not be started
+    queryPartitionWorker(&partitions[0]);
+    for (int partitionIndex = 1; partitionIndex < partitionCount; partitionIndex++) {
+        if (threadStarted[partitionIndex]) {
+            pthread_join(threads[partitionIndex], NULL);
+        } else {
+            queryPartitionWorker(&partitions[partitionIndex]);
+        }
+    }
+    // Merge partial results
+    QueryHeap **heaps = (QueryHeap **)malloc(partitionCount * sizeof(QueryHeap *));
+    for (int partitionIndex = 0; partitionIndex < partitionCount; partitionIndex++) {
+        heaps[partitionIndex] = partitions[partitionIndex].heap;
+    }
+    QueryHeap *heap = mergeQueryHeaps(heaps, partitionCount);
+    // Clean up
+    for (int partitionIndex = 0; partitionIndex < partitionCount; partitionIndex++) {
+        freeHeap(heaps[partitionIndex]);
+    }
+    free(heaps);
+    free(threadStarted);
+    free(threads);
+    free(partitions);
+    return heap;
+}
@@ -0,0 +1,62 @@
+/* QueryExecutor.h */
+#ifndef QUERY_EXECUTOR_H
+#define QUERY_EXECUTOR_H
+
+#include "QueryEngine.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Maximum number of worker threads of a query executor */
+#define MAX_QUERY_THREAD_COUNT 256
+
+/* Independent query evaluated by one worker thread, owns its own cursors and result heap */
+typedef struct QueryTask {
+    char *queryText;    // Query text, modified in place by tokenization
+    QueryMode queryMode;    // Evaluation strategy
+    double approximationFactor; // Threshold factor for Block-Max WAND
+    int partitionCount; // Number of docId ranges the query is split into, each evaluated on its own thread, 1 for none
+    QueryHeap *heap;    // Sorted query results, set by the worker
+    double latency; // Seconds spent tokenizing and evaluating the query, set by the worker
+} QueryTask;
+
+/* Part of a query restricted to one docId range, evaluated on its own thread */
+typedef struct QueryPartition {
+    const QueryEngine *engine;  // Shared engine
+    char **words;   // Query terms, shared by all partitions of the query
+    int wordCount;  // Number of query terms
+    QueryMode queryMode;    // Evaluation strategy
+    double approximationFactor; // Threshold factor for Block-Max WAND
+    int startDocId; // Start of the docId range (inclusive)
+    int endDocId;   // End of the docId range (exclusive)
+    QueryHeap *heap;    // Top-K results of the range, set by the thread
+} QueryPartition;
+
+/**
+ * Thread-pool query executor
+ * Worker threads stay alive between batches and evaluate independent queries against one shared read-only engine
+ */
+typedef struct QueryExecutor {
+    const QueryEngine *engine;  // Shared engine, only read by workers
+    int threadCount;    // Number of worker threads
+    pthread_t *threads; // Worker threads
+    pthread_mutex_t mutex;  // Protects batch state below
+    pthread_cond_t batchReady;  // Signalled when a new batch is published or the executor shuts down
+    pthread_cond_t batchDone;   // Signalled when the last worker leaves a batch
+    QueryTask *tasks;   // Tasks of the current batch
+    int taskCount;  // Number of tasks in the current batch
+    atomic_int nextTaskIndex;   // Next unclaimed task of the current batch
+    int batchNumber;    // Incremented for each published batch, so workers join every batch once
+    int activeThreadCount;  // Workers still working on the current batch
+    bool isShuttingDown;    // Set when workers should exit
+} QueryExecutor;
+
+/* Function prototypes */
+QueryExecutor *createQueryExecutor(const QueryEngine *engine, int threadCount); // Create a query executor and start its worker threads
+void freeQueryExecutor(QueryExecutor *executor);    // Stop the worker threads and free the query executor
+void executeQueryTasks(QueryExecutor *executor, QueryTask *tasks, int taskCount);   // Evaluate a batch of queries on the worker threads and wait for all of them
+void runQueryTask(const QueryEngine *engine, QueryTask *task);  // Evaluate a single query and record its results and latency
+void *queryWorker(void *arg);   // Worker thread loop of a query executor
+void *queryPartitionWorker(void *arg);  // Thread evaluating one docId range of a query
+QueryHeap *processQueryInParallel(const QueryEngine *engine, char **words, int wordCount, QueryMode queryMode, double approximationFactor, int partitionCount);  // Perform a query split into docId ranges evaluated on separate threads
+
+#endif
@@ -128,3 +128,49 @@ void heapSort(QueryHeap *heap) {
     }
     heap->nodeCount = originalSize;
 }
+
+int compareHeapNodesByDocId(const void *a, const void *b) {
+    return ((const QueryHeapNode *)a)->docId - ((const QueryHeapNode *)b)->docId;
+}
+
+/**
+ * Merges partial top-K heaps of disjoint document ID ranges into one sorted top-K heap
+ * Candidates are replayed in document ID order with the same insertion rule as the query loops,
+ * so every rank gets the same score as evaluating all ranges in one pass, only documents tied on score may be swapped
+ * @param heaps Partial heaps, each holding the top-K of its range
+ * @param heapCount Number of partial heaps
+ * @return Merged heap sorted by impact score
+ */
+QueryHeap *mergeQueryHeaps(QueryHeap **heaps, int heapCount) {
+    QueryHeap *heap = createHeap();
+    int candidateCount = 0;
+    for (int heapIndex = 0; heapIndex < heapCount; heapIndex++) {
+        candidateCount += heaps[heapIndex]->nodeCount;
+    }
+    QueryHeapNode *candidates = (QueryHeapNode *)malloc((candidateCount > 0 ? candidateCount : 1) * sizeof(QueryHeapNode));
+    if (candidates == NULL) {
+        printf("Error allocating memory!\n");
+        exit(1);
+    }
+    candidateCount = 0;
+    for (int heapIndex = 0; heapIndex < heapCount; heapIndex++) {
+        for (int i = 0; i < heaps[heapIndex]->nodeCount; i++) {
+            candidates[candidateCount++] = heaps[heapIndex]->heapNodes[i];
+        }
+    }
+    qsort(candidates, candidateCount, sizeof(QueryHeapNode), compareHeapNodesByDocId);
+    for (int i = 0; i < candidateCount; i++) {
+        if (heap->nodeCount < QUERY_HEAP_SIZE) {
+            // Heap not full - add directly
+            insertHeapNode(heap, candidates[i]);
+        } else if (candidates[i].impactScore > heap->heapNodes[0].impactScore) {
+            // Heap full but new score better than minimum - replace minimum
+            extractMin(heap);
+            insertHeapNode(heap, candidates[i]);
+        }
+    }
+    free(candidates);
+    // Sort results by impact score
+    heapSort(heap);
+    return heap;
+}
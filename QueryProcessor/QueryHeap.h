@@ -26,5 +26,7 @@ void buildHeap(QueryHeap *heap);    // Build a heap from an array of heap nodes
 QueryHeapNode extractMin(QueryHeap *heap);  // Extract the minimum node from the heap
 void insertHeapNode(QueryHeap *heap, QueryHeapNode heapNode);   // Insert a new node to the heap
 void heapSort(QueryHeap *heap); // Sort the heap in descending order
+int compareHeapNodesByDocId(const void *a, const void *b);  // Compare two heap nodes by docId for sorting
+QueryHeap *mergeQueryHeaps(QueryHeap **heaps, int heapCount);   // Merge partial top-K heaps of disjoint docId ranges into one
 
 #endif